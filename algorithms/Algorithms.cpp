@@ -6,10 +6,14 @@
 #include "Algorithms.hpp"
 
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <iostream>
 #include <queue>
+#include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -30,76 +34,123 @@ using std::queue;
 using std::string;
 using std::vector;
 
-// ~~~ declare the helper functions ~~~
-
-string constructCyclePath(vector<int>& path, int start);
+// the number of searches of one batch of multiSourceBfs (the bits of a mask)
+constexpr size_t MS_BFS_BATCH = 64;
+// direction-optimizing BFS: graphs with fewer vertices are searched top-down only
+constexpr size_t DIRECTION_OPTIMIZING_MIN_VERTICES = 4096;
+// switch to bottom-up when the edges of the frontier are more than 1/ALPHA of the edges of the unvisited vertices,
+// and back to top-down when the frontier has less than 1/BETA of the vertices (Beamer et al.)
+constexpr size_t BOTTOM_UP_ALPHA = 14;
+constexpr size_t TOP_DOWN_BETA = 24;
+// isConnected (and shortestPath of a MappedCsrGraph) search graphs with at least this many vertices with parallelBfs
+constexpr size_t PARALLEL_BFS_MIN_VERTICES = size_t(1) << 14;
+// the parallel algorithms split the work to this many tasks per thread, so a slow task does not hold the others back
+constexpr size_t TASKS_PER_THREAD = 4;
+// a parallel task gets at least this many vertices, smaller frontiers are relaxed on the calling thread
+constexpr size_t MIN_VERTICES_PER_TASK = 64;
+// "no path" in the matrix of floydWarshall: the sum of two of them does not overflow, and the values above FLOYD_WARSHALL_INF / 2 are INF
+constexpr int FLOYD_WARSHALL_INF = INF / 2;
 
-vector<vector<size_t>> dfs(const Graph& g);
-vector<size_t> dfs(const Graph& g, size_t src, vector<Color>* colors);
+// ~~~ declare the helper functions ~~~
 
-pair<vector<int>, vector<int>> bfs(const Graph& g, size_t src);
-pair<vector<int>, vector<int>> bellmanFord(const Graph& g, size_t src);
+string constructCyclePath(const Graph& g, vector<int>& path, int start);
+
+// the traversals work on any graph that provides neighbors(u) (Graph and MappedCsrGraph)
+template <typename G>
+bool isConnectedUtil(const G& g);
+template <typename G, typename Search>
+bool isConnectedBySearch(const G& g, const Search& search);
+template <typename G>
+vector<vector<size_t>> dfs(const G& g);
+template <typename G>
+vector<size_t> dfs(const G& g, size_t src, vector<Color>* colors);
+template <typename G>
+pair<vector<int>, vector<int>> bfs(const G& g, size_t src);
+void multiSourceBfsBatch(const Graph& g, const vector<size_t>& sources, size_t first, vector<vector<int>>& distances);
+pair<vector<int>, vector<int>> directionOptimizingBfs(const Graph& g, size_t src, bool ignoreDirection = false, vector<size_t>* order = nullptr);
+template <typename G>
+pair<vector<int>, vector<int>> parallelBfs(const G& g, size_t src);
+
+pair<vector<int>, vector<int>> bellmanFord(const Graph& g, size_t src, ExecutionPolicy execution);
 pair<vector<int>, vector<int>> bellmanFord(const Graph& g, size_t src, bool isDirected);
-pair<vector<int>, vector<int>> dijkstra(const Graph& g, size_t src);
+pair<vector<int>, vector<int>> spfa(const Graph& g, size_t src);
+pair<vector<int>, vector<int>> parallelBellmanFord(const Graph& g, size_t src);
+vector<int> subtreeDisassembly(const Graph& g);
+int findParentCycle(const vector<int>& parents);
+pair<vector<int>, vector<int>> dijkstra(const Graph& g, size_t src, size_t dest, QueuePolicy policy);
+template <typename Queue>
+pair<vector<int>, vector<int>> dijkstra(const Graph& g, size_t src, size_t dest, Queue pq);
+pair<vector<int>, vector<int>> deltaStepping(const Graph& g, size_t src, size_t dest);
+vector<int> dijkstraParents(const Graph& g, size_t src, const vector<int>& distances);
+void floydWarshallTile(int* c, int* cNext, const int* a, const int* aNext, const int* b, size_t stride);
+
+Algorithms::ShortestPathResult bidirectionalBfs(const Graph& g, size_t src, size_t dest);
+Algorithms::ShortestPathResult bidirectionalDijkstra(const Graph& g, size_t src, size_t dest);
+Algorithms::ShortestPathResult joinPaths(const vector<int>& forwardParents, const vector<int>& backwardParents, size_t meet, int distance);
 
 string isContainsCycleUtil(const Graph& g, size_t src, vector<Color>* colors, vector<int>* parents, vector<int>* path);
 
-// ~~~ implement the functions ~~~
-bool Algorithms::isConnected(const Graph& g) {
-    /*
-    to check if undirected graph is connected, we can perform DFS on the graph and check if all the vertices are discovered.
+vector<size_t> edgePartitions(const Graph& g, size_t numParts);
+uint64_t packLabel(int distance, int parent);
+pair<int, int> unpackLabel(uint64_t label);
+bool atomicMin(std::atomic<uint64_t>& target, uint64_t value);
 
-    The way to check if a directed graph is connected is to perform DFS twice:
-    1. Perform DFS on the graph.
-    2. If the DFS discovers all the vertices, then the graph is connected. (if we got only one DFS tree)
-    3. Perform DFS on the root of the last DFS tree.
-    4. If the DFS discovers all the vertices, then the graph is connected. otherwise, the graph is not connected.
-   */
-    // check if the graph is empty
-    if (g.getGraph().empty()) {
-        return true;
-    }
+/**
+ * @brief a view of a graph with all the edges reversed, backed by the transposed adjacency list of the graph
+ * can be passed to the traversals (dfs, bfs) to run them over the in-edges.
+ */
+class TransposedGraph {
+   public:
+    explicit TransposedGraph(const Graph& g) : g(g) {}
+    size_t getNumVertices() const { return g.getNumVertices(); }
+    bool isDirectedGraph() const { return g.isDirectedGraph(); }
+    const vector<pair<size_t, int>>& neighbors(size_t u) const { return g.inNeighbors(u); }
+
+   private:
+    const Graph& g;
+};
 
-    vector<vector<size_t>> firstDfsTree = dfs(g);
-    if (firstDfsTree.size() == 1) {
-        return true;
+// ~~~ implement the functions ~~~
+bool Algorithms::isConnected(const Graph& g) {
+    size_t n = g.getNumVertices();
+    if (n < DIRECTION_OPTIMIZING_MIN_VERTICES) {
+        return isConnectedUtil(g);
     }
-
-    // if the graph is undirected, the second DFS is not needed
-    if (!g.isDirectedGraph()) {
-        return false;
+    if (n < PARALLEL_BFS_MIN_VERTICES) {
+        return isConnectedBySearch(g, [&](size_t src) { return directionOptimizingBfs(g, src); });
     }
-
-    // Perform DFS on the root of the last DFS tree (the first element of the last vector in the firstDfsTree matrix
-    size_t firstElementOfLastVector = firstDfsTree.back().front();
-    vector<Color> colors(g.getGraph().size(), WHITE);
-    vector<size_t> secondDfsTree = dfs(g, firstElementOfLastVector, &colors);
-    return secondDfsTree.size() == g.getGraph().size();
+    return isConnectedBySearch(g, [&](size_t src) { return parallelBfs(g, src); });
 }
 
-string Algorithms::shortestPath(const Graph& g, size_t src, size_t dest) {
+Algorithms::ShortestPathResult Algorithms::findShortestPath(const Graph& g, size_t src, size_t dest, QueuePolicy policy, ExecutionPolicy execution) {
     // check for valid source and destination vertices
     if (src >= g.getGraph().size() || dest >= g.getGraph().size()) {
         throw std::invalid_argument("Invalid source or destination vertex");
     }
 
+    ShortestPathResult result{ShortestPathResult::Status::FOUND, 0, {}};
     if (src == dest) {
-        return std::to_string(src);
+        result.path.push_back(src);
+        return result;
     }
 
-    pair<vector<int>, vector<int>> shortestPathResult;
+    // if the graph was reordered, work with the internal ids and translate the path back to the original ids
+    src = g.toInternalId(src);
+    dest = g.toInternalId(dest);
+
+    pair<vector<int>, vector<int>> searchResult;
 
     // if the graph is not weighted, we can use BFS to find the shortest path
     if (!g.isWeightedGraph()) {
-        shortestPathResult = bfs(g, src);
+        searchResult = execution == ExecutionPolicy::PARALLEL ? parallelBfs(g, src) : directionOptimizingBfs(g, src);
     } else if (g.isHaveNegativeEdgeWeight()) {  // if the graph has negative edge weights, we can use Bellman-Ford algorithm
         try {
-            shortestPathResult = bellmanFord(g, src);
+            searchResult = bellmanFord(g, src, execution);
             if (!g.isDirectedGraph()) {  // if the graph is undirected, we can try to find the shortest path from the destination to the source
-                pair<vector<int>, vector<int>> bellmanResult2 = bellmanFord(g, dest);
+                pair<vector<int>, vector<int>> bellmanResult2 = bellmanFord(g, dest, execution);
 
                 // choose the correct result (the longer path)
-                vector<int> parents1 = shortestPathResult.second;
+                const vector<int>& parents1 = searchResult.second;
                 size_t path1Length = 0;
                 int parent = parents1[dest];
                 while (parent != -1) {
@@ -107,7 +158,7 @@ string Algorithms::shortestPath(const Graph& g, size_t src, size_t dest) {
                     parent = parents1[(size_t)parent];
                 }
 
-                vector<int> parents2 = bellmanResult2.second;
+                const vector<int>& parents2 = bellmanResult2.second;
                 size_t path2Length = 0;
                 parent = parents2[src];
                 while (parent != -1) {
@@ -116,52 +167,514 @@ string Algorithms::shortestPath(const Graph& g, size_t src, size_t dest) {
                 }
 
                 if (path1Length < path2Length) {  // update the result if needed
-                    shortestPathResult = bellmanResult2;
-
-                    // swap the source and destination vertices
-                    dest = src;
-                    // create the path from the source to the destination
-                    vector<int> parents = shortestPathResult.second;
-                    string path = std::to_string(dest);
-                    reverse(path.begin(), path.end());
-                    int parent = parents[dest];
-                    while (parent != -1) {
-                        string temp = std::to_string(parent);
-                        reverse(temp.begin(), temp.end());
-                        path.insert(0, temp + ">-");
-                        parent = parents[(size_t)parent];
+                    // the second search is rooted at the destination, so walking up from the source gives the path in order
+                    result.distance = bellmanResult2.first[src];
+                    for (int v = (int)src; v != -1; v = parents2[(size_t)v]) {
+                        result.path.push_back(g.toOriginalId((size_t)v));
                     }
-                    // reverse the path
-                    reverse(path.begin(), path.end());
-                    return path;
+                    return result;
                 }
             }
-        } catch (Algorithms::NegativeCycleException& e) {
-            return e.what();
+        } catch (Algorithms::NegativeCycleException&) {
+            result.status = ShortestPathResult::Status::NEGATIVE_CYCLE;
+            return result;
         }
     } else {  // if the graph has non-negative edge weights, we can use Dijkstra's algorithm
-        shortestPathResult = dijkstra(g, src);
+        searchResult = execution == ExecutionPolicy::PARALLEL ? deltaStepping(g, src, dest) : dijkstra(g, src, dest, policy);
     }
 
     // get the shortest path from the src to the dest
-    vector<int> distances = shortestPathResult.first;
-    vector<int> parents = shortestPathResult.second;
+    const vector<int>& distances = searchResult.first;
+    const vector<int>& parents = searchResult.second;
 
     // if the distance to the destination vertex is infinity, then there is no path between the source and destination vertices
     if (distances[dest] == INF) {
-        return "-1";
+        result.status = ShortestPathResult::Status::NO_PATH;
+        result.distance = INF;
+        return result;
+    }
+
+    // create the path from the destination back to the source, and reverse it
+    result.distance = distances[dest];
+    for (int v = (int)dest; v != -1; v = parents[(size_t)v]) {
+        result.path.push_back(g.toOriginalId((size_t)v));
+    }
+    reverse(result.path.begin(), result.path.end());
+    return result;
+}
+
+Algorithms::ShortestPathResult Algorithms::bidirectionalShortestPath(const Graph& g, size_t src, size_t dest) {
+    if (src >= g.getNumVertices() || dest >= g.getNumVertices()) {
+        throw std::invalid_argument("Invalid source or destination vertex");
+    }
+    if (src == dest || g.isHaveNegativeEdgeWeight()) {  // the bidirectional search needs non-negative weights
+        return findShortestPath(g, src, dest);
+    }
+
+    ShortestPathResult result = g.isWeightedGraph() ? bidirectionalDijkstra(g, g.toInternalId(src), g.toInternalId(dest))
+                                                    : bidirectionalBfs(g, g.toInternalId(src), g.toInternalId(dest));
+    for (size_t& v : result.path) {
+        v = g.toOriginalId(v);
+    }
+    return result;
+}
+
+Algorithms::ShortestPathTree Algorithms::shortestPathTree(const Graph& g, size_t src, QueuePolicy policy, ExecutionPolicy execution) {
+    size_t n = g.getNumVertices();
+    if (src >= n) {
+        throw std::invalid_argument("Invalid source vertex");
+    }
+    // findShortestPath picks between the searches from both ends of such a graph, so one tree from src can't give its answers
+    if (g.isHaveNegativeEdgeWeight() && !g.isDirectedGraph()) {
+        throw std::invalid_argument("A shortest path tree is not defined for undirected graphs with negative weights");
+    }
+
+    pair<vector<int>, vector<int>> searchResult;
+    try {
+        if (!g.isWeightedGraph()) {
+            searchResult = execution == ExecutionPolicy::PARALLEL ? parallelBfs(g, g.toInternalId(src)) : directionOptimizingBfs(g, g.toInternalId(src));
+        } else if (g.isHaveNegativeEdgeWeight()) {
+            searchResult = bellmanFord(g, g.toInternalId(src), execution);
+        } else {
+            searchResult = execution == ExecutionPolicy::PARALLEL ? deltaStepping(g, g.toInternalId(src), n) : dijkstra(g, g.toInternalId(src), n, policy);
+        }
+    } catch (Algorithms::NegativeCycleException&) {
+        return ShortestPathTree(src, vector<int>(n, INF), vector<int>(n, -1), true);
+    }
+
+    if (!g.isReordered()) {
+        return ShortestPathTree(src, std::move(searchResult.first), std::move(searchResult.second), false);
+    }
+
+    // index the tree by the original ids, so the queries don't need the graph
+    vector<int> distances(n);
+    vector<int> parents(n);
+    for (size_t v = 0; v < n; v++) {
+        int parent = searchResult.second[v];
+        distances[g.toOriginalId(v)] = searchResult.first[v];
+        parents[g.toOriginalId(v)] = parent == -1 ? -1 : (int)g.toOriginalId((size_t)parent);
+    }
+    return ShortestPathTree(src, std::move(distances), std::move(parents), false);
+}
+
+int Algorithms::ShortestPathTree::distanceTo(size_t v) const {
+    if (negativeCycle) {
+        throw std::runtime_error("Graph contains a negative-weight cycle");
+    }
+    return distances.at(v);
+}
+
+vector<size_t> Algorithms::ShortestPathTree::pathTo(size_t v) const {
+    if (distanceTo(v) == INF) {
+        return {};
+    }
+
+    vector<size_t> path;
+    for (int u = (int)v; u != -1; u = parents[(size_t)u]) {
+        path.push_back((size_t)u);
+    }
+    reverse(path.begin(), path.end());
+    return path;
+}
+
+Algorithms::ShortestPathResult Algorithms::ShortestPathTree::resultTo(size_t v) const {
+    if (v >= distances.size()) {
+        throw std::out_of_range("Invalid vertex");
+    }
+    if (negativeCycle) {
+        return {ShortestPathResult::Status::NEGATIVE_CYCLE, 0, {}};
+    }
+    if (distances[v] == INF) {
+        return {ShortestPathResult::Status::NO_PATH, INF, {}};
+    }
+    return {ShortestPathResult::Status::FOUND, distances[v], pathTo(v)};
+}
+
+Algorithms::AllPairsResult Algorithms::johnson(const Graph& g, bool withNextHops, ExecutionPolicy execution) {
+    size_t n = g.getNumVertices();
+    bool negativeWeights = g.isHaveNegativeEdgeWeight();
+    if (negativeWeights && !g.isDirectedGraph()) {
+        throw std::invalid_argument("Johnson's algorithm does not support undirected graphs with negative weights");
+    }
+
+    // the potentials - the distances from a virtual source with a 0 edge to every vertex (all 0 without negative weights)
+    vector<int> potentials(n, 0);
+    if (negativeWeights) {
+        try {
+            potentials = subtreeDisassembly(g);
+        } catch (Algorithms::NegativeCycleException&) {
+            return AllPairsResult(n, {}, {}, true);
+        }
+    }
+
+    // the reweighted in-edges in one flat array: the edges u -> v are at [offsets[v], offsets[v + 1]), with w(u, v) + h(u) - h(v) >= 0
+    vector<size_t> offsets(n + 1, 0);
+    vector<pair<size_t, int>> inEdges;
+    for (size_t v = 0; v < n; v++) {
+        for (auto [u, w] : g.inNeighbors(v)) {
+            inEdges.emplace_back(u, w + potentials[u] - potentials[v]);
+        }
+        offsets[v + 1] = inEdges.size();
+    }
+
+    vector<int> distances(n * n, INF);
+    vector<int> nextHops(withNextHops ? n * n : 0, -1);
+
+    // every task takes targets until there are none left, with its own queue and buffers.
+    // Dijkstra from the target over the in-edges finds the column of the target: the distance from every u, and the next hop of u -
+    // the vertex u was reached from. the tasks write to different columns.
+    ThreadPool& pool = ThreadPool::shared();
+    size_t numTasks = execution == ExecutionPolicy::PARALLEL ? std::min(pool.getNumThreads(), n) : 1;
+    std::atomic<size_t> nextTarget{0};
+    auto task = [&](size_t) {
+        IndexedDaryHeap<4> pq(n);
+        vector<int> reweighted(n, INF);
+        vector<int> parents(n, -1);
+        vector<size_t> settled;  // the vertices this run reached, to write them and to reset the buffers
+        for (size_t target = nextTarget++; target < n; target = nextTarget++) {
+            reweighted[target] = 0;
+            pq.push(target, 0);
+            while (!pq.empty()) {
+                size_t v = pq.pop().second;
+                settled.push_back(v);
+                for (size_t i = offsets[v]; i < offsets[v + 1]; i++) {
+                    auto [u, w] = inEdges[i];
+                    if (reweighted[v] + w < reweighted[u]) {
+                        reweighted[u] = reweighted[v] + w;
+                        parents[u] = (int)v;
+                        pq.push(u, reweighted[u]);
+                    }
+                }
+            }
+
+            // d(u, target) = d'(u, target) - h(u) + h(target)
+            size_t column = g.toOriginalId(target);
+            for (size_t u : settled) {
+                size_t cell = g.toOriginalId(u) * n + column;
+                distances[cell] = reweighted[u] - potentials[u] + potentials[target];
+                if (withNextHops && parents[u] != -1) {
+                    nextHops[cell] = (int)g.toOriginalId((size_t)parents[u]);
+                }
+                reweighted[u] = INF;
+                parents[u] = -1;
+            }
+            settled.clear();
+        }
+    };
+    if (numTasks <= 1) {
+        task(0);
+    } else {
+        pool.run(numTasks, task);
+    }
+    return AllPairsResult(n, std::move(distances), std::move(nextHops), false);
+}
+
+Algorithms::AllPairsResult Algorithms::floydWarshall(const Graph& g, bool withNextHops, ExecutionPolicy execution) {
+    size_t n = g.getNumVertices();
+    if (g.isHaveNegativeEdgeWeight() && !g.isDirectedGraph()) {
+        throw std::invalid_argument("Floyd-Warshall does not support undirected graphs with negative weights");
+    }
+
+    // one flat matrix, by the original ids, padded to whole tiles (the padding vertices have no edges)
+    const size_t block = FLOYD_WARSHALL_BLOCK;
+    size_t numBlocks = (n + block - 1) / block;
+    size_t stride = numBlocks * block;
+    vector<int> distances(stride * stride, FLOYD_WARSHALL_INF);
+    vector<int> nextHops(withNextHops ? stride * stride : 0, -1);
+    for (size_t v = 0; v < stride; v++) {
+        distances[v * stride + v] = 0;
+    }
+    for (size_t u = 0; u < n; u++) {
+        size_t row = g.toOriginalId(u) * stride;
+        for (auto [v, w] : g.neighbors(u)) {
+            distances[row + g.toOriginalId(v)] = w;
+            if (withNextHops) {
+                nextHops[row + g.toOriginalId(v)] = (int)g.toOriginalId(v);
+            }
+        }
+    }
+
+    // update the tile (i, j) with the paths through the vertices of the tile (k, k)
+    int* next = withNextHops ? nextHops.data() : nullptr;
+    auto update = [&](size_t i, size_t j, size_t k) {
+        size_t c = i * block * stride + j * block;
+        size_t a = i * block * stride + k * block;
+        size_t b = k * block * stride + j * block;
+        floydWarshallTile(distances.data() + c, next ? next + c : nullptr, distances.data() + a, next ? next + a : nullptr, distances.data() + b, stride);
+    };
+    ThreadPool& pool = ThreadPool::shared();
+    auto run = [&](size_t numTasks, const std::function<void(size_t)>& task) {
+        if (execution == ExecutionPolicy::SEQUENTIAL || numTasks == 1) {
+            for (size_t t = 0; t < numTasks; t++) {
+                task(t);
+            }
+        } else {
+            pool.run(numTasks, task);
+        }
+    };
+
+    for (size_t k = 0; k < numBlocks; k++) {
+        // phase 1: the diagonal tile, through its own vertices
+        update(k, k, k);
+
+        // phase 2: the other tiles of row k and of column k, through the diagonal tile
+        run(2 * (numBlocks - 1), [&](size_t t) {
+            size_t other = t / 2 < k ? t / 2 : t / 2 + 1;
+            if (t % 2 == 0) {
+                update(k, other, k);
+            } else {
+                update(other, k, k);
+            }
+        });
+
+        // phase 3: all the other tiles, through the tiles of row k and column k
+        run((numBlocks - 1) * (numBlocks - 1), [&](size_t t) {
+            size_t i = t / (numBlocks - 1);
+            size_t j = t % (numBlocks - 1);
+            update(i < k ? i : i + 1, j < k ? j : j + 1, k);
+        });
+
+        // a vertex with a negative distance to itself is on a negative cycle. stop as soon as one is found,
+        // the distances around a negative cycle keep going down (and may overflow)
+        for (size_t v = 0; v < n; v++) {
+            if (distances[v * stride + v] < 0) {
+                return AllPairsResult(n, {}, {}, true);
+            }
+        }
+    }
+
+    // drop the padding, and the values that only come from adding weights to FLOYD_WARSHALL_INF
+    vector<int> result(n * n);
+    vector<int> resultNextHops(withNextHops ? n * n : 0);
+    for (size_t u = 0; u < n; u++) {
+        for (size_t v = 0; v < n; v++) {
+            int distance = distances[u * stride + v];
+            result[u * n + v] = distance > FLOYD_WARSHALL_INF / 2 ? INF : distance;
+            if (withNextHops) {
+                resultNextHops[u * n + v] = distance > FLOYD_WARSHALL_INF / 2 ? -1 : nextHops[u * stride + v];
+            }
+        }
+    }
+    return AllPairsResult(n, std::move(result), std::move(resultNextHops), false);
+}
+
+size_t Algorithms::AllPairsResult::index(size_t u, size_t v) const {
+    if (u >= numVertices || v >= numVertices) {
+        throw std::out_of_range("Invalid vertex");
+    }
+    return u * numVertices + v;
+}
+
+int Algorithms::AllPairsResult::distance(size_t u, size_t v) const {
+    size_t cell = index(u, v);
+    if (negativeCycle) {
+        throw std::runtime_error("Graph contains a negative-weight cycle");
+    }
+    return distances[cell];
+}
+
+int Algorithms::AllPairsResult::nextHop(size_t u, size_t v) const {
+    size_t cell = index(u, v);
+    if (!hasNextHops()) {
+        throw std::logic_error("The next hops were not computed");
+    }
+    return nextHops[cell];
+}
+
+vector<size_t> Algorithms::AllPairsResult::path(size_t u, size_t v) const {
+    if (nextHop(u, v) == -1 && u != v) {
+        return {};
     }
 
-    // create the path from the source to the destination
-    string path = std::to_string(dest);
-    int parent = parents[dest];
-    while (parent != -1) {
-        path.insert(0, std::to_string(parent) + "->");
-        parent = parents[(size_t)parent];
+    vector<size_t> path{u};
+    for (size_t x = u; x != v; x = (size_t)nextHops[x * numVertices + v]) {
+        path.push_back((size_t)nextHops[x * numVertices + v]);
     }
     return path;
 }
 
+string Algorithms::shortestPath(const Graph& g, size_t src, size_t dest, ExecutionPolicy execution) {
+    return formatPath(findShortestPath(g, src, dest, QueuePolicy::AUTO, execution));
+}
+
+vector<Algorithms::ShortestPathResult> Algorithms::findShortestPaths(const Graph& g, const vector<pair<size_t, size_t>>& queries,
+                                                                     ExecutionPolicy execution) {
+    size_t n = g.getNumVertices();
+    for (auto [src, dest] : queries) {
+        if (src >= n || dest >= n) {
+            throw std::invalid_argument("Invalid source or destination vertex");
+        }
+    }
+
+    // an undirected graph with negative weights has no single tree per source (findShortestPath also searches from the destination),
+    // so every query runs findShortestPath
+    if (!g.isDirectedGraph() && g.isHaveNegativeEdgeWeight()) {
+        vector<ShortestPathResult> results(queries.size());
+        auto query = [&](size_t i) { results[i] = findShortestPath(g, queries[i].first, queries[i].second); };
+        if (execution == ExecutionPolicy::SEQUENTIAL) {
+            for (size_t i = 0; i < queries.size(); i++) {
+                query(i);
+            }
+        } else {
+            ThreadPool::shared().run(queries.size(), query);
+        }
+        return results;
+    }
+
+    // group the queries by source (a counting sort): the queries of src are byGroup[offsets[src]..offsets[src + 1])
+    vector<ShortestPathResult> results(queries.size());
+    vector<size_t> offsets(n + 1, 0);
+    for (size_t i = 0; i < queries.size(); i++) {
+        auto [src, dest] = queries[i];
+        if (src == dest) {  // no search, the same as findShortestPath
+            results[i] = {ShortestPathResult::Status::FOUND, 0, {src}};
+        } else {
+            offsets[src + 1]++;
+        }
+    }
+    vector<size_t> sources;
+    for (size_t src = 0; src < n; src++) {
+        if (offsets[src + 1] > 0) {
+            sources.push_back(src);
+        }
+        offsets[src + 1] += offsets[src];
+    }
+    vector<size_t> byGroup(offsets[n]);
+    vector<size_t> next(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < queries.size(); i++) {
+        if (queries[i].first != queries[i].second) {
+            byGroup[next[queries[i].first]++] = i;
+        }
+    }
+
+    // one search per source, its queries take the paths from the tree. the tasks write to different results
+    auto search = [&](size_t s, ExecutionPolicy treeExecution) {
+        size_t src = sources[s];
+        ShortestPathTree tree = shortestPathTree(g, src, QueuePolicy::AUTO, treeExecution);
+        for (size_t j = offsets[src]; j < offsets[src + 1]; j++) {
+            results[byGroup[j]] = tree.resultTo(queries[byGroup[j]].second);
+        }
+    };
+    if (execution == ExecutionPolicy::SEQUENTIAL || sources.size() == 1) {
+        for (size_t s = 0; s < sources.size(); s++) {
+            search(s, execution);
+        }
+    } else {
+        ThreadPool::shared().run(sources.size(), [&](size_t s) { search(s, ExecutionPolicy::SEQUENTIAL); });
+    }
+    return results;
+}
+
+vector<vector<int>> Algorithms::multiSourceBfs(const Graph& g, const vector<size_t>& sources, ExecutionPolicy execution) {
+    size_t n = g.getNumVertices();
+    for (size_t src : sources) {
+        if (src >= n) {
+            throw std::invalid_argument("Invalid source vertex");
+        }
+    }
+
+    vector<vector<int>> distances(sources.size(), vector<int>(n, INF));
+    size_t numBatches = (sources.size() + MS_BFS_BATCH - 1) / MS_BFS_BATCH;
+    auto batch = [&](size_t b) { multiSourceBfsBatch(g, sources, b * MS_BFS_BATCH, distances); };
+    if (execution == ExecutionPolicy::SEQUENTIAL || numBatches <= 1) {
+        for (size_t b = 0; b < numBatches; b++) {
+            batch(b);
+        }
+    } else {
+        ThreadPool::shared().run(numBatches, batch);
+    }
+    return distances;
+}
+
+vector<string> Algorithms::shortestPaths(const Graph& g, const vector<pair<size_t, size_t>>& queries, ExecutionPolicy execution) {
+    vector<ShortestPathResult> results = findShortestPaths(g, queries, execution);
+    vector<string> paths;
+    paths.reserve(results.size());
+    for (const ShortestPathResult& result : results) {
+        paths.push_back(formatPath(result));
+    }
+    return paths;
+}
+
+string Algorithms::formatPath(const ShortestPathResult& result) {
+    switch (result.status) {
+        case ShortestPathResult::Status::NO_PATH:
+            return "-1";
+        case ShortestPathResult::Status::NEGATIVE_CYCLE:
+            return "Graph contains a negative-weight cycle";
+        case ShortestPathResult::Status::FOUND:
+            break;
+    }
+
+    string path;
+    for (size_t i = 0; i < result.path.size(); i++) {
+        if (i > 0) {
+            path += "->";
+        }
+        path += std::to_string(result.path[i]);
+    }
+    return path;
+}
+
+bool Algorithms::isConnected(const MappedCsrGraph& g) {
+    if (g.getNumVertices() < PARALLEL_BFS_MIN_VERTICES) {
+        return isConnectedUtil(g);
+    }
+    return isConnectedBySearch(g, [&](size_t src) { return parallelBfs(g, src); });
+}
+
+Algorithms::ShortestPathResult Algorithms::findShortestPath(const MappedCsrGraph& g, size_t src, size_t dest) {
+    if (src >= g.getNumVertices() || dest >= g.getNumVertices()) {
+        throw std::invalid_argument("Invalid source or destination vertex");
+    }
+    if (g.isWeightedGraph()) {
+        throw std::invalid_argument("Only unweighted memory-mapped graphs are supported");
+    }
+
+    ShortestPathResult result{ShortestPathResult::Status::FOUND, 0, {}};
+    if (src == dest) {
+        result.path.push_back(src);
+        return result;
+    }
+
+    pair<vector<int>, vector<int>> searchResult = g.getNumVertices() < PARALLEL_BFS_MIN_VERTICES ? bfs(g, src) : parallelBfs(g, src);
+    const vector<int>& parents = searchResult.second;
+    if (parents[dest] == -1) {
+        result.status = ShortestPathResult::Status::NO_PATH;
+        result.distance = INF;
+        return result;
+    }
+
+    result.distance = searchResult.first[dest];
+    for (int v = (int)dest; v != -1; v = parents[(size_t)v]) {
+        result.path.push_back((size_t)v);
+    }
+    reverse(result.path.begin(), result.path.end());
+    return result;
+}
+
+string Algorithms::shortestPath(const MappedCsrGraph& g, size_t src, size_t dest) {
+    return formatPath(findShortestPath(g, src, dest));
+}
+
+bool Algorithms::isStronglyConnected(const Graph& g) {
+    /*
+    a graph is strongly connected iff every vertex is reachable from vertex 0, and vertex 0 is reachable from every vertex.
+    the second condition is the same as every vertex is reachable from vertex 0 in the transposed graph.
+    */
+    if (g.getNumVertices() == 0) {
+        return true;
+    }
+
+    vector<Color> colors(g.getNumVertices(), WHITE);
+    if (dfs(g, 0, &colors).size() != g.getNumVertices()) {
+        return false;
+    }
+
+    colors.assign(g.getNumVertices(), WHITE);
+    return dfs(TransposedGraph(g), 0, &colors).size() == g.getNumVertices();
+}
+
 string Algorithms::isContainsCycle(const Graph& g) {
     /*
     a graph contains a cycle if has a back edge.
@@ -191,69 +704,39 @@ string Algorithms::isBipartite(const Graph& g) {
 
     in the end, we will return the two sets of vertices, according to the colors of the vertices.
 
-    if the graph is directed, we will convert it to an undirected graph and then perform the algorithm.
+    if the graph is directed, we ignore the direction of the edges: the neighbors of a vertex are both its out-neighbors and its in-neighbors.
     */
     if (g.getGraph().empty()) {
         return "The graph is bipartite: A={}, B={}";
     }
 
-    // if the graph is directed, convert it to an undirected graph
-    if (g.isDirectedGraph()) {
-        Graph undirectedGraph;
-        // convert the directed graph to an undirected graph
-        vector<vector<int>> adjMatrix = g.getGraph();
+    // BFS from the first vertex, ignoring the direction of the edges. the color of a vertex is the parity of its level
+    size_t first = g.toInternalId(0);
+    vector<size_t> order;  // the vertices in the order they were discovered
+    vector<int> levels = directionOptimizingBfs(g, first, true, &order).first;
 
-        // make the graph symmetric (we don't care about the edge weights, we just need to know if there is an edge or not)
-        for (size_t i = 0; i < adjMatrix.size(); i++) {
-            for (size_t j = 0; j < adjMatrix.size(); j++) {
-                if (adjMatrix[i][j] != NO_EDGE) {
-                    adjMatrix[j][i] = adjMatrix[i][j];
-                }
+    // an edge between two vertices with the same color (in the same level, or in two levels of the same parity) is an odd cycle
+    for (size_t u : order) {
+        for (auto [v, w] : g.neighbors(u)) {
+            if (levels[v] % 2 == levels[u] % 2) {
+                return "The graph is not bipartite";
             }
         }
-
-        undirectedGraph.loadGraph(adjMatrix);
-
-        // perform the algorithm on the undirected graph
-        return isBipartite(undirectedGraph);
     }
 
-    size_t n = g.getGraph().size();
-    // create a list of colors for the vertices
-    vector<Color> colors(n, WHITE);
-
     // create two sets of vertices (A and B)
     vector<size_t> setB;
     vector<size_t> setR;
+    for (size_t v : order) {
+        (levels[v] % 2 == 0 ? setB : setR).push_back(v);
+    }
 
-    // start BFS from the first vertex (and color the graph with two colors)
-    queue<size_t> q;
-    q.push(0);
-    colors[0] = BLUE;
-    setB.push_back(0);  // add the first vertex to the blue set
-
-    while (!q.empty()) {
-        size_t u = q.front();
-        q.pop();
-        for (size_t v = 0; v < n; v++) {  // loop over the neighbors of the vertex
-            if (g.getGraph()[u][v] != NO_EDGE) {
-                if (colors[v] == colors[u]) {  // if the vertex is colored with the same color as its neighbor
-                    return "The graph is not bipartite";
-                }
-
-                if (colors[v] == WHITE) {  // if the vertex is not discovered yet
-                                           // color the vertex with the opposite color of its parent
-                    if (colors[u] == BLUE) {
-                        colors[v] = RED;
-                        setR.push_back(v);
-                    } else {
-                        colors[v] = BLUE;
-                        setB.push_back(v);
-                    }
-                    q.push(v);  // add the vertex to the queue (this is the first time we discover it)
-                }
-            }
-        }
+    // translate the sets back to the original ids (if the graph was reordered)
+    for (size_t& v : setB) {
+        v = g.toOriginalId(v);
+    }
+    for (size_t& v : setR) {
+        v = g.toOriginalId(v);
     }
 
     // create the result string
@@ -277,52 +760,20 @@ string Algorithms::isBipartite(const Graph& g) {
 
 string Algorithms::negativeCycle(const Graph& g) {
     /*
-    To find a negative cycle in the graph, we will add a new vertex to the graph and connect it to all the other vertices with an edge of weight 0.
-    Then we will perform Bellman-Ford algorithm from the new vertex.
-
-    on the last part on the Bellman-Ford algorithm, if we can relax an edge, then the graph contains a negative cycle.
+    Bellman-Ford from all the vertices at once: every vertex starts with distance 0 (as if a new vertex was connected to all of them
+    with weight 0, but without building that graph). a negative cycle is found with Tarjan's subtree disassembly, as soon as it
+    closes in the parent graph (see subtreeDisassembly).
 
     to get the negative cycle, we will go back with the `parents` vector until we reach the vertex we started from.
-
-    because in our graph representation, no edges have a weight of 0, in this function we will change the NO_EDGE value to INFINITY.
     */
-
-    size_t n = g.getGraph().size();
-
-    // create a new graph with a new vertex
-    Graph newGraph;  // we will build a directed graph, and save if g was directed or not
-    bool isDirected = g.isDirectedGraph();
-
-    vector<vector<int>> newGraphMat(n + 1, vector<int>(n + 1, INF));
-    // copy the graph to the new graph
-    for (size_t i = 0; i < n; i++) {
-        for (size_t j = 0; j < n; j++) {
-            if (i == j) {
-                newGraphMat[i][j] = NO_EDGE;
-            }
-            if (g.getGraph()[i][j] != NO_EDGE) {
-                newGraphMat[i][j] = g.getGraph()[i][j];
-            }
-        }
-    }
-
-    // connect the new vertex to all the other vertices with an edge of weight 0 (if NO_EDGE = 0 we will put -1)
-    for (size_t i = 0; i < n; i++) {
-        newGraphMat[n][i] = NO_EDGE != 0 ? 0 : -1;
-    }
-    newGraphMat[n][n] = NO_EDGE;
-
-    newGraph.loadGraph(newGraphMat);
-
-    // start Bellman-Ford algorithm from the new vertex`
     try {
-        bellmanFord(newGraph, n, isDirected);
-    } catch (Algorithms::NegativeCycleException e) {  // if the graph contains a negative cycle
+        subtreeDisassembly(g);
+    } catch (Algorithms::NegativeCycleException& e) {  // if the graph contains a negative cycle
         // get the negative cycle
         vector<size_t> cycle = e.cycle;
-        string cycleStr = std::to_string(cycle[0]);
+        string cycleStr = std::to_string(g.toOriginalId(cycle[0]));
         for (size_t i = 1; i < cycle.size(); i++) {
-            cycleStr += "->" + std::to_string(cycle[i]);
+            cycleStr += "->" + std::to_string(g.toOriginalId(cycle[i]));
         }
         return cycleStr;
     }
@@ -334,27 +785,84 @@ string Algorithms::negativeCycle(const Graph& g) {
 // ~ DFS ~
 
 /**
-  @brief Perform DFS on the graph
-  @param g - the graph to perform DFS on
-  @return a list of vertices in the order they were discovered
-*/
-vector<vector<size_t>> dfs(const Graph& g) {
-    size_t n = g.getGraph().size();
-    // create a list of colors for the vertices
-    vector<Color> colors(n, WHITE);
-
-    // create result dfs "tree" (we will return it as a matrix of edges)
-    vector<vector<size_t>> dfsTree;
+ * @brief the implementation of Algorithms::isConnected, for any graph that provides neighbors(u) (Graph and MappedCsrGraph)
+ */
+template <typename G>
+bool isConnectedUtil(const G& g) {
+    /*
+    to check if undirected graph is connected, we can perform DFS on the graph and check if all the vertices are discovered.
 
-    // start loop over all vertices
-    for (size_t i = 0; i < n; i++) {
-        if (colors[i] == WHITE) {
-            // do DFS from vertex i
-            dfsTree.push_back(dfs(g, i, &colors));
-        }
+    The way to check if a directed graph is connected is to perform DFS twice:
+    1. Perform DFS on the graph.
+    2. If the DFS discovers all the vertices, then the graph is connected. (if we got only one DFS tree)
+    3. Perform DFS on the root of the last DFS tree.
+    4. If the DFS discovers all the vertices, then the graph is connected. otherwise, the graph is not connected.
+   */
+    // check if the graph is empty
+    if (g.getNumVertices() == 0) {
+        return true;
     }
-    return dfsTree;
-}
+
+    vector<vector<size_t>> firstDfsTree = dfs(g);
+    if (firstDfsTree.size() == 1) {
+        return true;
+    }
+
+    // if the graph is undirected, the second DFS is not needed
+    if (!g.isDirectedGraph()) {
+        return false;
+    }
+
+    // Perform DFS on the root of the last DFS tree (the first element of the last vector in the firstDfsTree matrix
+    size_t firstElementOfLastVector = firstDfsTree.back().front();
+    vector<Color> colors(g.getNumVertices(), WHITE);
+    vector<size_t> secondDfsTree = dfs(g, firstElementOfLastVector, &colors);
+    return secondDfsTree.size() == g.getNumVertices();
+}
+
+/**
+ * @brief isConnected for the large graphs, with a search from a vertex that returns the distances (and the parents):
+ * if the search from the first vertex reaches all the vertices the graph is connected, and an undirected graph that it doesn't cover is not.
+ * otherwise only the root of the last DFS tree can reach all the vertices (see isConnectedUtil)
+ */
+template <typename G, typename Search>
+bool isConnectedBySearch(const G& g, const Search& search) {
+    auto reachesAll = [&](size_t src) {
+        vector<int> distances = search(src).first;
+        return std::find(distances.begin(), distances.end(), INF) == distances.end();
+    };
+    if (reachesAll(0)) {
+        return true;
+    }
+    if (!g.isDirectedGraph()) {
+        return false;
+    }
+    return reachesAll(dfs(g).back().front());
+}
+
+/**
+  @brief Perform DFS on the graph
+  @param g - the graph to perform DFS on
+  @return a list of vertices in the order they were discovered
+*/
+template <typename G>
+vector<vector<size_t>> dfs(const G& g) {
+    size_t n = g.getNumVertices();
+    // create a list of colors for the vertices
+    vector<Color> colors(n, WHITE);
+
+    // create result dfs "tree" (we will return it as a matrix of edges)
+    vector<vector<size_t>> dfsTree;
+
+    // start loop over all vertices
+    for (size_t i = 0; i < n; i++) {
+        if (colors[i] == WHITE) {
+            // do DFS from vertex i
+            dfsTree.push_back(dfs(g, i, &colors));
+        }
+    }
+    return dfsTree;
+}
 
 /**
  * @brief Perform DFS from a given source vertex
@@ -363,9 +871,8 @@ vector<vector<size_t>> dfs(const Graph& g) {
  * @param colors - colors of the vertices
  * @return a list of vertices in the order they were discovered
  */
-vector<size_t> dfs(const Graph& g, size_t src, vector<Color>* colors) {
-    size_t n = g.getGraph().size();
-
+template <typename G>
+vector<size_t> dfs(const G& g, size_t src, vector<Color>* colors) {
     vector<size_t> dfsOrder;
 
     // create a stack to store the vertices (instead of recursion)
@@ -380,11 +887,9 @@ vector<size_t> dfs(const Graph& g, size_t src, vector<Color>* colors) {
             // discover the vertex and loop over its neighbors
             (*colors)[u] = GRAY;
             dfsOrder.push_back(u);
-            for (size_t v = 0; v < n; v++) {
-                if (g.getGraph()[u][v] != NO_EDGE) {  // if there is an edge between u and v
-                    if ((*colors)[v] == WHITE) {      // if we didn't discover v yet
-                        stack.push_back(v);           // add v to the stack
-                    }
+            for (auto [v, w] : g.neighbors(u)) {
+                if ((*colors)[v] == WHITE) {  // if we didn't discover v yet
+                    stack.push_back(v);       // add v to the stack
                 }
             }
         } else if ((*colors)[u] == GRAY) {
@@ -393,11 +898,12 @@ vector<size_t> dfs(const Graph& g, size_t src, vector<Color>* colors) {
     }
 
     return dfsOrder;
-};
+}
 
 // ~ Shortest Path algorithms ~
-pair<vector<int>, vector<int>> bfs(const Graph& g, size_t src) {
-    size_t n = g.getGraph().size();
+template <typename G>
+pair<vector<int>, vector<int>> bfs(const G& g, size_t src) {
+    size_t n = g.getNumVertices();
 
     // init the distances and parents vectors
     vector<int> distances(n, INF);
@@ -411,26 +917,374 @@ pair<vector<int>, vector<int>> bfs(const Graph& g, size_t src) {
     while (!q.empty()) {
         size_t u = q.front();
         q.pop();
-        for (size_t v = 0; v < n; v++) {
-            if (g.getGraph()[u][v] != NO_EDGE) {
-                if (distances[v] == INF) {  // if the vertex is not discovered yet
-                    distances[v] = distances[u] + 1;
-                    parents[v] = (int)u;
-                    q.push(v);
+        for (auto [v, w] : g.neighbors(u)) {
+            if (distances[v] == INF) {  // if the vertex is not discovered yet
+                distances[v] = distances[u] + 1;
+                parents[v] = (int)u;
+                q.push(v);
+            }
+        }
+    }
+
+    return {distances, parents};
+}
+
+/**
+ * @brief BFS from src, level by level, in one of two directions for every level (Beamer's direction-optimizing BFS):
+ * top-down - the vertices of the frontier scan their out-edges for vertices that were not visited yet (the same order as bfs),
+ * bottom-up - every vertex that was not visited yet scans its in-edges for a parent in the frontier (a bitmap), and stops at the first one.
+ * in the middle levels of a low-diameter graph the frontier is most of the graph, and bottom-up skips most of its edges.
+ * graphs with less than DIRECTION_OPTIMIZING_MIN_VERTICES vertices are searched top-down only, with the same result as bfs.
+ * @param ignoreDirection - search the undirected view of a directed graph (the out-edges and the in-edges of every vertex)
+ * @param order - if not null, gets the vertices in the order they were discovered (level by level)
+ * @return the distances (the number of edges) and the parents
+ */
+pair<vector<int>, vector<int>> directionOptimizingBfs(const Graph& g, size_t src, bool ignoreDirection, vector<size_t>* order) {
+    size_t n = g.getNumVertices();
+    bool bothLists = ignoreDirection && g.isDirectedGraph();
+    vector<int> distances(n, INF);
+    vector<int> parents(n, -1);
+    if (order != nullptr) {
+        order->clear();
+        order->push_back(src);
+    }
+
+    // the edges that are scanned from a vertex, in the top-down direction (the bottom-up direction scans the same number)
+    auto degree = [&](size_t u) { return g.neighbors(u).size() + (bothLists ? g.inNeighbors(u).size() : 0); };
+    size_t unvisitedEdges = 0;
+    if (n >= DIRECTION_OPTIMIZING_MIN_VERTICES) {
+        for (size_t u = 0; u < n; u++) {
+            unvisitedEdges += degree(u);
+        }
+    }
+
+    static const vector<pair<size_t, int>> noEdges;
+    vector<size_t> frontier{src};
+    vector<size_t> next;
+    vector<uint64_t> inFrontier((n + 63) / 64, 0);  // the bitmap of the frontier, for the bottom-up levels
+    distances[src] = 0;
+    bool bottomUp = false;
+    for (int level = 1; !frontier.empty(); level++) {
+        if (n >= DIRECTION_OPTIMIZING_MIN_VERTICES) {
+            size_t frontierEdges = 0;
+            for (size_t u : frontier) {
+                frontierEdges += degree(u);
+            }
+            unvisitedEdges -= frontierEdges;
+            if (!bottomUp && frontierEdges > unvisitedEdges / BOTTOM_UP_ALPHA) {
+                bottomUp = true;
+            } else if (bottomUp && frontier.size() < n / TOP_DOWN_BETA) {
+                bottomUp = false;
+            }
+        }
+
+        next.clear();
+        if (!bottomUp) {
+            for (size_t u : frontier) {
+                // merge the sorted out-list with the sorted in-list (empty unless bothLists), so the neighbors come by increasing id
+                const vector<pair<size_t, int>>& out = g.neighbors(u);
+                const vector<pair<size_t, int>>& in = bothLists ? g.inNeighbors(u) : noEdges;
+                for (size_t i = 0, j = 0; i < out.size() || j < in.size();) {
+                    size_t v = j == in.size() || (i < out.size() && out[i].first < in[j].first) ? out[i++].first : in[j++].first;
+                    if (distances[v] == INF) {
+                        distances[v] = level;
+                        parents[v] = (int)u;
+                        next.push_back(v);
+                    }
+                }
+            }
+        } else {
+            for (size_t u : frontier) {
+                inFrontier[u / 64] |= uint64_t(1) << (u % 64);
+            }
+            auto findParent = [&](size_t v, const vector<pair<size_t, int>>& edges) {
+                for (auto [u, w] : edges) {
+                    if ((inFrontier[u / 64] >> (u % 64)) & 1) {
+                        distances[v] = level;
+                        parents[v] = (int)u;
+                        next.push_back(v);
+                        return true;
+                    }
+                }
+                return false;
+            };
+            for (size_t v = 0; v < n; v++) {
+                if (distances[v] == INF && !findParent(v, g.inNeighbors(v)) && bothLists) {
+                    findParent(v, g.neighbors(v));
                 }
             }
+            for (size_t u : frontier) {
+                inFrontier[u / 64] = 0;
+            }
+        }
+
+        if (order != nullptr) {
+            order->insert(order->end(), next.begin(), next.end());
         }
+        frontier.swap(next);
     }
+    return {distances, parents};
+}
+
+/**
+ * @brief BFS from src on the threads of ThreadPool::shared(), level by level (level-synchronous).
+ * top-down - the frontier is split to chunks, and a task claims a neighbor with a compare-and-swap of its parent (from -1),
+ * so every vertex is discovered by exactly one task. every task keeps the vertices it discovered in its own buffer,
+ * and the buffers are copied to the next frontier at the offsets of a prefix sum of their sizes.
+ * bottom-up (Graph only, it needs the in-edges) - the vertices are split to ranges, and every task looks for the parents of the
+ * unvisited vertices of its range in a bitmap of the frontier. the levels switch between the two like directionOptimizingBfs.
+ * the distances are the same as bfs, but a vertex with several parents in the frontier gets the one whose task claimed it first.
+ * @return the distances (the number of edges) and the parents
+ */
+template <typename G>
+pair<vector<int>, vector<int>> parallelBfs(const G& g, size_t src) {
+    constexpr bool hasInEdges = std::is_same_v<G, Graph>;
+    size_t n = g.getNumVertices();
+    ThreadPool& pool = ThreadPool::shared();
+    size_t maxTasks = pool.getNumThreads() * TASKS_PER_THREAD;
+
+    // split [0, size) to ranges of at least MIN_VERTICES_PER_TASK and run task(t, first, last) on every range, one range on the calling thread
+    auto forRanges = [&](size_t size, auto&& task) {
+        size_t numTasks = std::clamp<size_t>(size / MIN_VERTICES_PER_TASK, 1, maxTasks);
+        auto rangeTask = [&](size_t t) { task(t, size * t / numTasks, size * (t + 1) / numTasks); };
+        if (numTasks == 1) {
+            rangeTask(0);
+        } else {
+            pool.run(numTasks, rangeTask);
+        }
+        return numTasks;
+    };
 
+    vector<int> distances(n, INF);
+    vector<std::atomic<int>> claimed(n);     // the parents during the search, -1 if the vertex was not discovered yet
+    vector<vector<size_t>> found(maxTasks);  // the vertices every task discovered in this level
+    vector<size_t> foundEdges(maxTasks, 0);  // and the sum of their degrees
+    vector<size_t> offsets(maxTasks + 1, 0);
+    // the bitmaps of the frontiers of the even and the odd levels, so the bits of one level are cleared while the next level's are set
+    vector<std::atomic<uint64_t>> inFrontier[2];
+
+    bool directionOptimizing = hasInEdges && n >= DIRECTION_OPTIMIZING_MIN_VERTICES;
+    size_t numTasks = forRanges(n, [&](size_t t, size_t first, size_t last) {
+        for (size_t v = first; v < last; v++) {
+            claimed[v].store(-1, std::memory_order_relaxed);
+            if (directionOptimizing) {
+                foundEdges[t] += g.neighbors(v).size();
+            }
+        }
+    });
+    size_t unvisitedEdges = 0;
+    for (size_t t = 0; t < numTasks; t++) {
+        unvisitedEdges += foundEdges[t];
+        foundEdges[t] = 0;
+    }
+    if (directionOptimizing) {
+        for (vector<std::atomic<uint64_t>>& bitmap : inFrontier) {
+            bitmap = vector<std::atomic<uint64_t>>((n + 63) / 64);
+            for (std::atomic<uint64_t>& word : bitmap) {
+                word.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // the same rule as directionOptimizingBfs, with the size and the edges of the frontier of the next level
+    bool bottomUp = false;
+    auto chooseDirection = [&](size_t frontierSize, size_t frontierEdges) {
+        if (directionOptimizing) {
+            unvisitedEdges -= frontierEdges;
+            if (!bottomUp && frontierEdges > unvisitedEdges / BOTTOM_UP_ALPHA) {
+                bottomUp = true;
+            } else if (bottomUp && frontierSize < n / TOP_DOWN_BETA) {
+                bottomUp = false;
+            }
+        }
+    };
+    auto setBit = [](vector<std::atomic<uint64_t>>& bitmap, size_t v, bool value) {
+        uint64_t bit = uint64_t(1) << (v % 64);
+        if (value) {
+            bitmap[v / 64].fetch_or(bit, std::memory_order_relaxed);
+        } else {
+            bitmap[v / 64].fetch_and(~bit, std::memory_order_relaxed);
+        }
+    };
+
+    vector<size_t> frontier{src};
+    vector<size_t> next;
+    distances[src] = 0;
+    claimed[src].store((int)src, std::memory_order_relaxed);  // not -1, so it is not claimed again
+    chooseDirection(1, g.neighbors(src).size());
+    if (bottomUp) {
+        setBit(inFrontier[0], src, true);
+    }
+
+    for (int level = 1; !frontier.empty(); level++) {
+        vector<std::atomic<uint64_t>>& currentBitmap = inFrontier[(size_t)(level - 1) % 2];
+        vector<std::atomic<uint64_t>>& nextBitmap = inFrontier[(size_t)level % 2];
+        bool wasBottomUp = bottomUp;
+        auto discover = [&](size_t t, size_t v) {
+            distances[v] = level;
+            found[t].push_back(v);
+            if (directionOptimizing) {
+                foundEdges[t] += g.neighbors(v).size();
+            }
+        };
+
+        if (!bottomUp) {
+            numTasks = forRanges(frontier.size(), [&](size_t t, size_t first, size_t last) {
+                for (size_t i = first; i < last; i++) {
+                    size_t u = frontier[i];
+                    for (auto [v, w] : g.neighbors(u)) {
+                        int unclaimed = -1;
+                        if (claimed[v].load(std::memory_order_relaxed) == -1 &&
+                            claimed[v].compare_exchange_strong(unclaimed, (int)u, std::memory_order_relaxed)) {
+                            discover(t, v);
+                        }
+                    }
+                }
+            });
+        } else if constexpr (hasInEdges) {
+            numTasks = forRanges(n, [&](size_t t, size_t first, size_t last) {
+                for (size_t v = first; v < last; v++) {
+                    if (distances[v] != INF) {
+                        continue;
+                    }
+                    for (auto [u, w] : g.inNeighbors(v)) {
+                        if ((currentBitmap[u / 64].load(std::memory_order_relaxed) >> (u % 64)) & 1) {
+                            claimed[v].store((int)u, std::memory_order_relaxed);  // only this task looks at v
+                            discover(t, v);
+                            break;
+                        }
+                    }
+                }
+            });
+        }
+
+        // the prefix sum of the sizes of the buffers are the offsets of the tasks in the next frontier
+        size_t nextEdges = 0;
+        for (size_t t = 0; t < numTasks; t++) {
+            offsets[t + 1] = offsets[t] + found[t].size();
+            nextEdges += foundEdges[t];
+            foundEdges[t] = 0;
+        }
+        chooseDirection(offsets[numTasks], nextEdges);
+
+        // copy the buffers, clear the bits of the frontier and set the bits of the next frontier (if the levels need them)
+        next.resize(offsets[numTasks]);
+        size_t numCopies = numTasks;
+        auto copy = [&](size_t t) {
+            std::copy(found[t].begin(), found[t].end(), next.begin() + (std::ptrdiff_t)offsets[t]);
+            if (bottomUp) {
+                for (size_t v : found[t]) {
+                    setBit(nextBitmap, v, true);
+                }
+            }
+            found[t].clear();
+            if (wasBottomUp) {
+                for (size_t i = frontier.size() * t / numCopies; i < frontier.size() * (t + 1) / numCopies; i++) {
+                    setBit(currentBitmap, frontier[i], false);
+                }
+            }
+        };
+        if (numCopies == 1) {
+            copy(0);
+        } else {
+            pool.run(numCopies, copy);
+        }
+        frontier.swap(next);
+    }
+
+    vector<int> parents(n);
+    forRanges(n, [&](size_t, size_t first, size_t last) {
+        for (size_t v = first; v < last; v++) {
+            parents[v] = claimed[v].load(std::memory_order_relaxed);
+        }
+    });
+    parents[src] = -1;
     return {distances, parents};
 }
 
-pair<vector<int>, vector<int>> bellmanFord(const Graph& g, size_t src) {
-    return bellmanFord(g, src, g.isDirectedGraph());
+/**
+ * @brief one batch of multiSourceBfs: the searches from sources[first], ..., sources[first + 63] (or the last source), level by level.
+ * bit i of a mask is the search from sources[first + i]. seen[v] - the searches that reached v, visit[v] - the searches whose frontier
+ * is at v in this level. a vertex of the frontier scans its out-edges once, and passes to every neighbor the searches that did not reach it yet.
+ * @param distances - the rows of the sources, filled with the distances of the vertices (by the original ids)
+ */
+void multiSourceBfsBatch(const Graph& g, const vector<size_t>& sources, size_t first, vector<vector<int>>& distances) {
+    size_t n = g.getNumVertices();
+    size_t count = std::min(MS_BFS_BATCH, sources.size() - first);
+    vector<uint64_t> seen(n, 0);
+    vector<uint64_t> visit(n, 0);
+    vector<uint64_t> visitNext(n, 0);
+    vector<size_t> frontier;  // the vertices with visit[v] != 0
+    vector<size_t> nextFrontier;
+
+    for (size_t i = 0; i < count; i++) {
+        size_t src = g.toInternalId(sources[first + i]);
+        if (visit[src] == 0) {
+            frontier.push_back(src);
+        }
+        seen[src] |= uint64_t(1) << i;
+        visit[src] |= uint64_t(1) << i;
+        distances[first + i][sources[first + i]] = 0;
+    }
+
+    for (int level = 1; !frontier.empty(); level++) {
+        for (size_t u : frontier) {
+            uint64_t searches = visit[u];
+            for (auto [v, w] : g.neighbors(u)) {
+                uint64_t reached = searches & ~seen[v];
+                if (reached != 0) {
+                    if (visitNext[v] == 0) {
+                        nextFrontier.push_back(v);
+                    }
+                    visitNext[v] |= reached;
+                    seen[v] |= reached;
+                }
+            }
+            visit[u] = 0;
+        }
+
+        for (size_t v : nextFrontier) {
+            size_t original = g.toOriginalId(v);
+            for (uint64_t searches = visitNext[v]; searches != 0; searches &= searches - 1) {  // every set bit
+                distances[first + (size_t)__builtin_ctzll(searches)][original] = level;
+            }
+        }
+        visit.swap(visitNext);  // visit is all 0 now, it is the next visitNext
+        frontier.swap(nextFrontier);
+        nextFrontier.clear();
+    }
+}
+
+/**
+ * @brief Bellman-Ford from src. directed graphs use the queue-based variant (SPFA), or the parallel rounds if the execution is PARALLEL.
+ * undirected graphs keep the passes over all the edges (the edge back to the parent is skipped, and which edge that is depends on
+ * the order of the relaxations, so they are not relaxed in parallel). for the same reason, a reordered undirected graph is searched
+ * in the original order, and the result is translated back to the internal ids - so reorder() doesn't change the answers.
+ */
+pair<vector<int>, vector<int>> bellmanFord(const Graph& g, size_t src, ExecutionPolicy execution) {
+    if (!g.isDirectedGraph()) {
+        if (!g.isReordered()) {
+            return bellmanFord(g, src, false);
+        }
+        Graph original = g;
+        original.reorder(VertexOrder::ORIGINAL);
+        auto [originalDistances, originalParents] = bellmanFord(original, g.toOriginalId(src), false);
+
+        size_t n = g.getNumVertices();
+        vector<int> distances(n, INF);
+        vector<int> parents(n, -1);
+        for (size_t v = 0; v < n; v++) {
+            size_t internal = g.toInternalId(v);
+            distances[internal] = originalDistances[v];
+            parents[internal] = originalParents[v] == -1 ? -1 : (int)g.toInternalId((size_t)originalParents[v]);
+        }
+        return {distances, parents};
+    }
+    return execution == ExecutionPolicy::PARALLEL ? parallelBellmanFord(g, src) : spfa(g, src);
 }
 
 pair<vector<int>, vector<int>> bellmanFord(const Graph& g, size_t src, bool isDirected) {
-    size_t n = g.getGraph().size();
+    size_t n = g.getNumVertices();
     vector<int> distances(n, INF);
     vector<int> parents(n, -1);
 
@@ -440,26 +1294,20 @@ pair<vector<int>, vector<int>> bellmanFord(const Graph& g, size_t src, bool isDi
         bool relaxed = false;  // if we dont relax any edge in the current iteration, then we can break the loop
         // for each edge (u, v) in the graph
         for (size_t u = 0; u < n; u++) {
-            for (size_t v = 0; v < n; v++) {
-                // if there is an edge between u and v
-                if (g.getGraph()[u][v] != NO_EDGE) {
-                    // if the graph is undirected, we should ignore the edge that connects the current vertex to its parent
-                    if (!isDirected && parents[u] == (int)v) {
-                        if (distances[u] + g.getGraph()[u][v] < distances[v]) {
-                        }
-                        continue;
-                    }
-
-                    // relax the edge (u, v)
-                    if (distances[u] == INF || g.getGraph()[u][v] == NO_EDGE) {
-                        continue;
-                    }
+            if (distances[u] == INF) {
+                continue;
+            }
+            for (auto [v, w] : g.neighbors(u)) {
+                // if the graph is undirected, we should ignore the edge that connects the current vertex to its parent
+                if (!isDirected && parents[u] == (int)v) {
+                    continue;
+                }
 
-                    if (distances[u] + g.getGraph()[u][v] < distances[v]) {
-                        distances[v] = distances[u] + g.getGraph()[u][v];
-                        parents[v] = (int)u;
-                        relaxed = true;
-                    }
+                // relax the edge (u, v)
+                if (distances[u] + w < distances[v]) {
+                    distances[v] = distances[u] + w;
+                    parents[v] = (int)u;
+                    relaxed = true;
                 }
             }
         }
@@ -470,21 +1318,387 @@ pair<vector<int>, vector<int>> bellmanFord(const Graph& g, size_t src, bool isDi
 
     // check for negative-weight cycles
     for (size_t u = 0; u < n; u++) {
-        for (size_t v = 0; v < n; v++) {
-            if (g.getGraph()[u][v] != NO_EDGE) {
-                // if the graph is undirected, we should ignore the edge that connects the current vertex to its parent
-                if (!isDirected && parents[u] == (int)v) {
-                    continue;
-                }
+        if (distances[u] == INF) {
+            continue;
+        }
+        for (auto [v, w] : g.neighbors(u)) {
+            // if the graph is undirected, we should ignore the edge that connects the current vertex to its parent
+            if (!isDirected && parents[u] == (int)v) {
+                continue;
+            }
 
-                if (distances[u] == INF || g.getGraph()[u][v] == INF) {
-                    continue;
+            if (distances[u] + w < distances[v]) {
+                parents[v] = (int)u;
+                throw Algorithms::NegativeCycleException(v, parents);
+            }
+        }
+    }
+
+    return std::make_pair(distances, parents);
+}
+
+/**
+ * @brief queue-based Bellman-Ford (SPFA) for directed graphs: only the vertices whose distance changed are scanned again,
+ * so on sparse graphs it usually runs in about O(E) instead of O(V * E).
+ * a cycle in the parent graph is always a negative cycle, so the parent graph is checked for a cycle every |V| relaxations
+ * (O(V) work for every |V| relaxations, so the check does not change the running time).
+ * @throw NegativeCycleException if there is a negative cycle that is reachable from src
+ */
+pair<vector<int>, vector<int>> spfa(const Graph& g, size_t src) {
+    size_t n = g.getNumVertices();
+    vector<int> distances(n, INF);
+    vector<int> parents(n, -1);
+    vector<bool> inQueue(n, false);
+    queue<size_t> q;
+
+    distances[src] = 0;
+    q.push(src);
+    inQueue[src] = true;
+    size_t relaxations = 0;
+    while (!q.empty()) {
+        size_t u = q.front();
+        q.pop();
+        inQueue[u] = false;
+
+        for (auto [v, w] : g.neighbors(u)) {
+            if (distances[u] + w < distances[v]) {
+                distances[v] = distances[u] + w;
+                parents[v] = (int)u;
+
+                if (++relaxations % n == 0) {
+                    int cycleVertex = findParentCycle(parents);
+                    if (cycleVertex != -1) {
+                        throw Algorithms::NegativeCycleException((size_t)cycleVertex, parents);
+                    }
+                }
+                if (!inQueue[v]) {
+                    q.push(v);
+                    inQueue[v] = true;
                 }
+            }
+        }
+    }
+
+    return std::make_pair(distances, parents);
+}
+
+/**
+ * @brief queue-based Bellman-Ford from all the vertices (all the distances start at 0), with Tarjan's subtree disassembly:
+ * the parents form a tree (a forest), and when the distance of v improves, all the vertices in the subtree of v are removed from
+ * the tree, because their distances will improve too (they are not scanned until then). if the vertex u that improved v is
+ * in the subtree of v, the new edge u -> v closes a cycle in the parent graph - a negative cycle, found as soon as it is formed.
+ * if the graph is undirected, the edge back to the parent is skipped (like in bellmanFord), so an edge is not a cycle by itself.
+ * @return the distances from the virtual source: d(v) <= d(u) + w(u, v) for every edge of a directed graph (the potentials of johnson)
+ * @throw NegativeCycleException if the graph contains a negative cycle
+ */
+vector<int> subtreeDisassembly(const Graph& g) {
+    size_t n = g.getNumVertices();
+    bool isDirected = g.isDirectedGraph();
+    vector<int> distances(n, 0);
+    vector<int> parents(n, -1);
+    vector<bool> inTree(n, true);  // false for the vertices that were removed from the tree (their distance is out of date)
+    vector<bool> inQueue(n, true);
+    // the children of every vertex, as a doubly linked list
+    vector<int> firstChild(n, -1);
+    vector<int> nextSibling(n, -1);
+    vector<int> prevSibling(n, -1);
+    vector<size_t> subtree;
+
+    queue<size_t> q;
+    for (size_t v = 0; v < n; v++) {
+        q.push(v);
+    }
+    while (!q.empty()) {
+        size_t u = q.front();
+        q.pop();
+        inQueue[u] = false;
+        if (!inTree[u]) {
+            continue;  // a vertex of a removed subtree - it will be added again when its distance improves
+        }
 
-                if (distances[u] + g.getGraph()[u][v] < distances[v]) {
+        for (auto [v, w] : g.neighbors(u)) {
+            if ((!isDirected && parents[u] == (int)v) || distances[u] + w >= distances[v]) {
+                continue;
+            }
+
+            // remove the subtree of v (without v). if u is in it, u -> v closes a cycle
+            subtree.clear();
+            for (int child = firstChild[v]; child != -1; child = nextSibling[(size_t)child]) {
+                subtree.push_back((size_t)child);
+            }
+            for (size_t i = 0; i < subtree.size(); i++) {
+                size_t x = subtree[i];
+                if (x == u) {
                     parents[v] = (int)u;
                     throw Algorithms::NegativeCycleException(v, parents);
                 }
+                for (int child = firstChild[x]; child != -1; child = nextSibling[(size_t)child]) {
+                    subtree.push_back((size_t)child);
+                }
+            }
+            for (size_t x : subtree) {
+                inTree[x] = false;
+                parents[x] = -1;
+                firstChild[x] = -1;
+            }
+
+            // move v under u (if v has a parent, the parent is in the tree, otherwise v would be removed with it)
+            if (parents[v] != -1) {
+                if (prevSibling[v] == -1) {
+                    firstChild[(size_t)parents[v]] = nextSibling[v];
+                } else {
+                    nextSibling[(size_t)prevSibling[v]] = nextSibling[v];
+                }
+                if (nextSibling[v] != -1) {
+                    prevSibling[(size_t)nextSibling[v]] = prevSibling[v];
+                }
+            }
+            firstChild[v] = -1;
+            prevSibling[v] = -1;
+            nextSibling[v] = firstChild[u];
+            if (firstChild[u] != -1) {
+                prevSibling[(size_t)firstChild[u]] = (int)v;
+            }
+            firstChild[u] = (int)v;
+
+            distances[v] = distances[u] + w;
+            parents[v] = (int)u;
+            inTree[v] = true;
+            if (!inQueue[v]) {
+                q.push(v);
+                inQueue[v] = true;
+            }
+        }
+    }
+    return distances;
+}
+
+/**
+ * @brief delta-stepping on the threads of ThreadPool::shared(), for non-negative weights.
+ * the vertices are kept in buckets of width delta by their tentative distance. the buckets are settled in order: the light edges
+ * (weight <= delta) of the vertices in the current bucket are relaxed again and again until the bucket stays empty (they may add
+ * vertices back to it), and then the heavy edges of all the vertices that were settled in the bucket are relaxed once.
+ * the vertices of a bucket are relaxed in parallel: every task writes its relaxation requests to its own buffer, and then the
+ * requests are applied (no atomics and no locks on the distances). the parents are computed at the end with dijkstraParents.
+ * the distances are the same as in the sequential dijkstra, and the parents make shortest paths, but not always the same ones.
+ * @param dest - the target vertex (the search stops after the bucket of dest is settled), or |V| to search the whole graph
+ */
+pair<vector<int>, vector<int>> deltaStepping(const Graph& g, size_t src, size_t dest) {
+    size_t n = g.getNumVertices();
+    ThreadPool& pool = ThreadPool::shared();
+    size_t maxTasks = pool.getNumThreads() * TASKS_PER_THREAD;
+
+    // delta ~ the max weight / the average degree: a bucket holds about one edge of work per vertex
+    auto maxWeight = (size_t)std::max(g.getMaxEdgeWeight(), 1);
+    size_t averageDegree = std::max<size_t>(g.getNumEdges() / std::max<size_t>(n, 1), 1);
+    size_t delta = std::max<size_t>(maxWeight / averageDegree, 1);
+    // all the tentative distances are in [i * delta, i * delta + maxWeight] when bucket i is settled, so the buckets are reused cyclically
+    size_t numBuckets = maxWeight / delta + 2;
+
+    vector<int> distances(n, INF);
+    vector<vector<size_t>> buckets(numBuckets);
+    vector<vector<pair<size_t, int>>> requests(maxTasks);  // the requests of every task (vertex, new distance)
+    vector<size_t> settledIn(n, SIZE_MAX);                 // the bucket the vertex was settled in
+    vector<size_t> inFrontier(n, SIZE_MAX);                // the last frontier the vertex was in (to skip duplicates)
+    vector<size_t> frontier;
+    vector<size_t> settled;
+
+    // relax the light or the heavy edges of the vertices, and then apply the requests
+    auto relax = [&](const vector<size_t>& vertices, bool light) {
+        size_t numTasks = std::min(maxTasks, (vertices.size() + MIN_VERTICES_PER_TASK - 1) / MIN_VERTICES_PER_TASK);
+        auto task = [&](size_t t) {
+            for (size_t i = vertices.size() * t / numTasks; i < vertices.size() * (t + 1) / numTasks; i++) {
+                size_t u = vertices[i];
+                for (auto [v, w] : g.neighbors(u)) {
+                    if (((size_t)w <= delta) == light && distances[u] + w < distances[v]) {
+                        requests[t].emplace_back(v, distances[u] + w);
+                    }
+                }
+            }
+        };
+        if (numTasks == 1) {
+            task(0);
+        } else {
+            pool.run(numTasks, task);
+        }
+
+        for (size_t t = 0; t < numTasks; t++) {
+            for (auto [v, distance] : requests[t]) {
+                if (distance < distances[v]) {
+                    distances[v] = distance;
+                    buckets[(size_t)distance / delta % numBuckets].push_back(v);
+                }
+            }
+            requests[t].clear();
+        }
+    };
+
+    distances[src] = 0;
+    buckets[0].push_back(src);
+    size_t numFrontiers = 0;
+    for (size_t i = 0, emptyBuckets = 0; emptyBuckets < numBuckets; i++) {
+        vector<size_t>& bucket = buckets[i % numBuckets];
+        if (bucket.empty()) {
+            emptyBuckets++;
+            continue;
+        }
+        emptyBuckets = 0;
+
+        settled.clear();
+        while (!bucket.empty()) {
+            numFrontiers++;
+            frontier.clear();
+            for (size_t v : bucket) {
+                // skip the duplicates, and the vertices that moved to a lower bucket (cyclically, the same slot)
+                if ((size_t)distances[v] / delta != i || inFrontier[v] == numFrontiers) {
+                    continue;
+                }
+                inFrontier[v] = numFrontiers;
+                frontier.push_back(v);
+                if (settledIn[v] != i) {
+                    settledIn[v] = i;
+                    settled.push_back(v);
+                }
+            }
+            bucket.clear();
+            relax(frontier, true);
+        }
+        relax(settled, false);
+
+        if (dest < n && settledIn[dest] == i) {
+            break;
+        }
+    }
+
+    vector<int> parents = dijkstraParents(g, src, distances);
+    return {distances, parents};
+}
+
+/**
+ * @brief parents for these distances, by the rule Dijkstra's algorithm follows when it settles the vertices in the order of
+ * (distance, id): the parent of v is the in-neighbor u with d(u) + w(u, v) = d(v) and the smallest (d(u), u). computed in parallel
+ * over the in-edges. every walk up the parents is a shortest path, but when there are ties the sequential dijkstra may have kept
+ * a different parent with the same distance.
+ */
+vector<int> dijkstraParents(const Graph& g, size_t src, const vector<int>& distances) {
+    size_t n = g.getNumVertices();
+    vector<int> parents(n, -1);
+    ThreadPool& pool = ThreadPool::shared();
+    size_t numTasks = std::min(pool.getNumThreads() * TASKS_PER_THREAD, (n + MIN_VERTICES_PER_TASK - 1) / MIN_VERTICES_PER_TASK);
+
+    pool.run(numTasks, [&](size_t t) {
+        for (size_t v = n * t / numTasks; v < n * (t + 1) / numTasks; v++) {
+            if (v == src || distances[v] == INF) {
+                continue;
+            }
+            for (auto [u, w] : g.inNeighbors(v)) {
+                if (distances[u] != INF && distances[u] + w == distances[v] &&
+                    (parents[v] == -1 || distances[u] < distances[(size_t)parents[v]])) {
+                    parents[v] = (int)u;  // the in-neighbors are sorted by id, so the first one with the smallest distance is kept
+                }
+            }
+        }
+    });
+    return parents;
+}
+
+/**
+ * @brief the update of one tile of floydWarshall: c[i][j] = min(c[i][j], a[i][k] + b[k][j]) for every k of the tile, in order
+ * (so c may be a or b, for the tiles of phases 1 and 2). the inner loop has no branches, so the compiler vectorizes it.
+ * @param c, a, b - the first cells of the tiles, in a matrix with rows of `stride` cells
+ * @param cNext, aNext - the next hops of the tiles c and a, or nullptr without next hops
+ */
+void floydWarshallTile(int* c, int* cNext, const int* a, const int* aNext, const int* b, size_t stride) {
+    const size_t block = FLOYD_WARSHALL_BLOCK;
+    for (size_t k = 0; k < block; k++) {
+        const int* bRow = b + k * stride;
+        for (size_t i = 0; i < block; i++) {
+            int aik = a[i * stride + k];
+            if (aik > FLOYD_WARSHALL_INF / 2) {
+                continue;  // no path from i to k, nothing to update in the row
+            }
+            int* cRow = c + i * stride;
+            if (cNext == nullptr) {
+                for (size_t j = 0; j < block; j++) {
+                    cRow[j] = std::min(cRow[j], aik + bRow[j]);
+                }
+            } else {
+                int* nextRow = cNext + i * stride;
+                int nextHop = aNext[i * stride + k];  // the first vertex on the path from i to k
+                for (size_t j = 0; j < block; j++) {
+                    int through = aik + bRow[j];
+                    nextRow[j] = through < cRow[j] ? nextHop : nextRow[j];
+                    cRow[j] = std::min(cRow[j], through);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Bellman-Ford in rounds on the threads of ThreadPool::shared(), for directed graphs.
+ * a round relaxes the out-edges of the vertices that changed in the last round. the vertices are split to ranges with about
+ * the same number of edges, one task per range. the round reads the distances of the last round and writes a (distance, parent) label
+ * with an atomic min, so the result of a round does not depend on the order of the threads: the distances, the parents and
+ * the negative cycle that is found are the same in every run. it stops after a round without changes.
+ * @throw NegativeCycleException if there is a negative cycle that is reachable from src
+ */
+pair<vector<int>, vector<int>> parallelBellmanFord(const Graph& g, size_t src) {
+    size_t n = g.getNumVertices();
+    ThreadPool& pool = ThreadPool::shared();
+    vector<size_t> parts = edgePartitions(g, pool.getNumThreads() * TASKS_PER_THREAD);
+    size_t numParts = parts.size() - 1;
+
+    vector<int> distances(n, INF);
+    vector<int> parents(n, -1);
+    vector<std::atomic<uint64_t>> labels(n);  // the labels of the current round
+    vector<char> active(n, 0);                // the vertices that changed in the last round
+    vector<char> partChanged(numParts, 0);
+
+    distances[src] = 0;
+    active[src] = 1;
+    for (size_t v = 0; v < n; v++) {
+        labels[v] = packLabel(distances[v], parents[v]);
+    }
+
+    for (size_t round = 1; true; round++) {
+        // relax the out-edges of the active vertices, with the distances of the last round
+        pool.run(numParts, [&](size_t part) {
+            for (size_t u = parts[part]; u < parts[part + 1]; u++) {
+                if (!active[u]) {
+                    continue;
+                }
+                for (auto [v, w] : g.neighbors(u)) {
+                    int currDist = distances[u] + w;
+                    if (currDist < distances[v]) {
+                        atomicMin(labels[v], packLabel(currDist, (int)u));
+                    }
+                }
+            }
+        });
+
+        // take the new labels
+        pool.run(numParts, [&](size_t part) {
+            partChanged[part] = 0;
+            for (size_t v = parts[part]; v < parts[part + 1]; v++) {
+                auto [distance, parent] = unpackLabel(labels[v]);
+                active[v] = distance < distances[v];
+                if (active[v]) {
+                    distances[v] = distance;
+                    parents[v] = parent;
+                    partChanged[part] = 1;
+                }
+            }
+        });
+
+        if (std::find(partChanged.begin(), partChanged.end(), 1) == partChanged.end()) {
+            break;
+        }
+        // without a negative cycle, all the distances are final after |V| - 1 rounds. after that, look for the cycle in the parents
+        if (round >= n) {
+            int cycleVertex = findParentCycle(parents);
+            if (cycleVertex != -1) {
+                throw Algorithms::NegativeCycleException((size_t)cycleVertex, parents);
             }
         }
     }
@@ -493,48 +1707,102 @@ pair<vector<int>, vector<int>> bellmanFord(const Graph& g, size_t src, bool isDi
 }
 
 /**
- * @brief Perform Dijkstra's algorithm from a given source vertex
+ * @brief find a cycle in the parent graph (every vertex has at most one parent, so every walk up the parents ends in the root or in a cycle)
+ * @return a vertex on a cycle, or -1 if there is no cycle
+ */
+int findParentCycle(const vector<int>& parents) {
+    size_t n = parents.size();
+    vector<size_t> walk(n, n);  // walk[v] - the first vertex of the walk that visited v (n if no walk visited it yet)
+    for (size_t start = 0; start < n; start++) {
+        int v = (int)start;
+        while (v != -1 && walk[(size_t)v] == n) {
+            walk[(size_t)v] = start;
+            v = parents[(size_t)v];
+        }
+        if (v != -1 && walk[(size_t)v] == start) {  // the walk got back to a vertex it visited - a cycle
+            return v;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Perform Dijkstra's algorithm from a given source vertex, with the priority queue selected by the policy
  * @param g - the graph to perform Dijkstra's algorithm on (must be a non-negative weighted graph)
  * @param src - the source vertex to start Dijkstra's algorithm from
+ * @param dest - the target vertex (the search stops when it is settled), or |V| to search the whole graph
+ * @param policy - the priority queue (AUTO uses Dial's buckets for small weights, and the 4-ary heap otherwise)
  * @return a pair of two vectors:
  * 1. the first vector contains the distance from the source vertex to each vertex in the graph
- * 2. the second vector contains the parent of each vertex in the graph in the BFS tree
- *
+ * 2. the second vector contains the parent of each vertex in the graph in the shortest path tree
+ */
+pair<vector<int>, vector<int>> dijkstra(const Graph& g, size_t src, size_t dest, QueuePolicy policy) {
+    size_t n = g.getNumVertices();
+
+    // the weights are small integers - the buckets are cheaper than a heap
+    if (policy == QueuePolicy::AUTO && g.getMaxEdgeWeight() <= DIAL_MAX_EDGE_WEIGHT) {
+        policy = QueuePolicy::DIAL;
+    }
+
+    switch (policy) {
+        case QueuePolicy::BINARY_HEAP:
+            return dijkstra(g, src, dest, BinaryHeap(n));
+        case QueuePolicy::PAIRING_HEAP:
+            return dijkstra(g, src, dest, PairingHeap(n));
+        case QueuePolicy::DIAL:
+            return dijkstra(g, src, dest, DialBuckets(n, g.getMaxEdgeWeight()));
+        case QueuePolicy::RADIX_HEAP:
+            return dijkstra(g, src, dest, RadixHeap(n));
+        case QueuePolicy::AUTO:
+        case QueuePolicy::DARY_HEAP:
+            break;
+    }
+    return dijkstra(g, src, dest, IndexedDaryHeap<4>(n));
+}
+
+/**
+ * @brief Dijkstra's algorithm from src. if dest is a vertex of the graph, stop as soon as dest is settled:
+ * the distances and the parents on the path to dest are final at that point, the rest of the vertices may not be.
+ * @tparam Queue - the priority queue (see Heaps.hpp), push(v, key) inserts v or decreases its key
+ * @param g - the graph (with non-negative weights)
+ * @param src - the source vertex
+ * @param dest - the target vertex, or |V| to search the whole graph
+ * @param pq - an empty queue for |V| vertices
+ * @return the distances and the parents vectors
  */
-pair<vector<int>, vector<int>> dijkstra(const Graph& g, size_t src) {
-    size_t n = g.getGraph().size();
+template <typename Queue>
+pair<vector<int>, vector<int>> dijkstra(const Graph& g, size_t src, size_t dest, Queue pq) {
+    size_t n = g.getNumVertices();
     vector<int> distances(n, INF);
     vector<int> parents(n, -1);
+    vector<bool> settled(n, false);  // the vertices that were already popped with their final distance
 
-    // create priority queue - min heap
-    /* in here:
-    1. pair<int, size_t> - first int is the distance from the source vertex to the vertex, second int is the vertex
-    2. vector<pair<int, size_t>> - the type of the container (what is the container that holds the elements)
-    3. greater<pair<int, int>> - the comparator (how to compare the elements in the container)
-        greater is a functor that compares two elements and returns true if the first element is greater than the second element
-        when we pass pair<int, int> to the priority_queue, it will compare the first element of the pair
-    */
-    std::priority_queue<pair<int, size_t>, vector<pair<int, size_t>>, std::greater<pair<int, int>>> pq;
-
+    // the queue holds every discovered vertex that is not settled yet, with its current distance as the key
     // initialize source vertex
     distances[src] = 0;
-    pq.push(std::make_pair(0, src));
+    pq.push(src, 0);
 
     while (!pq.empty()) {
         // get the vertex with the smallest distance
-        size_t u = pq.top().second;
-        pq.pop();
+        size_t u = pq.pop().second;
+        settled[u] = true;
+
+        // the distance to the target is final, no need to continue
+        if (u == dest) {
+            break;
+        }
 
         // for each neighbor of u
-        for (size_t v = 0; v < n; v++) {
-            if (g.getGraph()[u][v] != NO_EDGE) {
-                // relax the edge
-                int currDist = distances[u] + g.getGraph()[u][v];
-                if (currDist < distances[v]) {
-                    distances[v] = currDist;
-                    parents[v] = u;
-                    pq.push(std::make_pair(distances[v], v));
-                }
+        for (auto [v, w] : g.neighbors(u)) {
+            if (settled[v]) {
+                continue;
+            }
+            // relax the edge
+            int currDist = distances[u] + w;
+            if (currDist < distances[v]) {
+                distances[v] = currDist;
+                parents[v] = (int)u;
+                pq.push(v, currDist);
             }
         }
     }
@@ -542,6 +1810,122 @@ pair<vector<int>, vector<int>> dijkstra(const Graph& g, size_t src) {
     return make_pair(distances, parents);
 }
 
+/**
+ * @brief bidirectional BFS: expand a full level of the smaller frontier at a time (the forward one over the out-edges,
+ * the backward one over the in-edges). when an edge of the level reaches a vertex the other search already discovered,
+ * the shortest path goes through one of the edges of this level, so we finish the level and stop.
+ * @return the result, with the internal ids
+ */
+Algorithms::ShortestPathResult bidirectionalBfs(const Graph& g, size_t src, size_t dest) {
+    size_t n = g.getNumVertices();
+    vector<int> distances[2] = {vector<int>(n, INF), vector<int>(n, INF)};  // 0 - forward, 1 - backward
+    vector<int> parents[2] = {vector<int>(n, -1), vector<int>(n, -1)};
+    vector<size_t> frontiers[2] = {{src}, {dest}};
+    distances[0][src] = 0;
+    distances[1][dest] = 0;
+
+    int best = INF;
+    size_t meet = 0;
+    while (best == INF && !frontiers[0].empty() && !frontiers[1].empty()) {
+        size_t side = frontiers[0].size() <= frontiers[1].size() ? 0 : 1;
+        vector<size_t> next;
+        for (size_t u : frontiers[side]) {
+            const vector<pair<size_t, int>>& edges = side == 0 ? g.neighbors(u) : g.inNeighbors(u);
+            for (auto [v, w] : edges) {
+                if (distances[side][v] == INF) {
+                    distances[side][v] = distances[side][u] + 1;
+                    parents[side][v] = (int)u;
+                    next.push_back(v);
+                }
+                // v was discovered by the other search - the searches met
+                if (distances[1 - side][v] != INF && distances[side][v] + distances[1 - side][v] < best) {
+                    best = distances[side][v] + distances[1 - side][v];
+                    meet = v;
+                }
+            }
+        }
+        frontiers[side] = std::move(next);
+    }
+
+    if (best == INF) {
+        return {Algorithms::ShortestPathResult::Status::NO_PATH, INF, {}};
+    }
+    return joinPaths(parents[0], parents[1], meet, best);
+}
+
+/**
+ * @brief bidirectional Dijkstra: settle one vertex from the forward search (over the out-edges) and one from the backward search
+ * (over the in-edges) in turns. `best` is the shortest path found so far through a vertex that both searches reached,
+ * and we stop when the distances of the last settled vertices of the two searches can't give a shorter path.
+ * @return the result, with the internal ids
+ */
+Algorithms::ShortestPathResult bidirectionalDijkstra(const Graph& g, size_t src, size_t dest) {
+    size_t n = g.getNumVertices();
+    vector<int> distances[2] = {vector<int>(n, INF), vector<int>(n, INF)};  // 0 - forward, 1 - backward
+    vector<int> parents[2] = {vector<int>(n, -1), vector<int>(n, -1)};
+    vector<bool> settled[2] = {vector<bool>(n, false), vector<bool>(n, false)};
+    IndexedDaryHeap<4> queues[2] = {IndexedDaryHeap<4>(n), IndexedDaryHeap<4>(n)};
+    long long lastKeys[2] = {0, 0};  // the distance of the last settled vertex of every search
+
+    distances[0][src] = 0;
+    distances[1][dest] = 0;
+    queues[0].push(src, 0);
+    queues[1].push(dest, 0);
+
+    long long best = INF;
+    size_t meet = 0;
+    size_t side = 1;
+    while (!queues[0].empty() && !queues[1].empty()) {
+        side = 1 - side;  // alternate between the searches
+        auto [d, u] = queues[side].pop();
+        settled[side][u] = true;
+        lastKeys[side] = d;
+
+        // every path that was not found yet is at least as long as the last settled distances of the two searches
+        if (lastKeys[0] + lastKeys[1] >= best) {
+            break;
+        }
+
+        const vector<pair<size_t, int>>& edges = side == 0 ? g.neighbors(u) : g.inNeighbors(u);
+        for (auto [v, w] : edges) {
+            int currDist = distances[side][u] + w;
+            if (settled[side][v] || currDist >= distances[side][v]) {
+                continue;
+            }
+            distances[side][v] = currDist;
+            parents[side][v] = (int)u;
+            queues[side].push(v, currDist);
+
+            // v was reached by the other search - a path through v
+            if (distances[1 - side][v] != INF && (long long)currDist + distances[1 - side][v] < best) {
+                best = (long long)currDist + distances[1 - side][v];
+                meet = v;
+            }
+        }
+    }
+
+    if (best == INF) {
+        return {Algorithms::ShortestPathResult::Status::NO_PATH, INF, {}};
+    }
+    return joinPaths(parents[0], parents[1], meet, (int)best);
+}
+
+/**
+ * @brief build the path of a bidirectional search: from the source to the meeting vertex with the forward parents,
+ * and from the meeting vertex to the destination with the backward parents.
+ */
+Algorithms::ShortestPathResult joinPaths(const vector<int>& forwardParents, const vector<int>& backwardParents, size_t meet, int distance) {
+    Algorithms::ShortestPathResult result{Algorithms::ShortestPathResult::Status::FOUND, distance, {}};
+    for (int v = (int)meet; v != -1; v = forwardParents[(size_t)v]) {
+        result.path.push_back((size_t)v);
+    }
+    reverse(result.path.begin(), result.path.end());
+    for (int v = backwardParents[meet]; v != -1; v = backwardParents[(size_t)v]) {
+        result.path.push_back((size_t)v);
+    }
+    return result;
+}
+
 // ~ Cycle detection ~
 
 /**
@@ -566,23 +1950,21 @@ string isContainsCycleUtil(const Graph& g, size_t src, vector<Color>* colors, ve
     path->push_back(src);  // add the vertex to the path
 
     // loop over all the neighbors of the vertex
-    for (size_t v = 0; v < g.getGraph().size(); v++) {
-        if (g.getGraph()[src][v] != NO_EDGE) {
-            if ((*colors)[v] == WHITE) {
-                // dfs on the neighbor
-                (*parents)[v] = (int)src;
-                string cycle = isContainsCycleUtil(g, v, colors, parents, path);
-                if (!cycle.empty()) {  // if a cycle is detected
-                    return cycle;
-                }
-            } else if ((*colors)[v] == GRAY) {  // if the neighbor is gray, then we have a cycle
-                // if the graph is undirected, we should ignore the edge that connects the current vertex to its parent
-                if (!g.isDirectedGraph() && (*parents)[src] == (int)v) {
-                    continue;
-                }
-                // construct the cycle path
-                return constructCyclePath(*path, v);
+    for (auto [v, w] : g.neighbors(src)) {
+        if ((*colors)[v] == WHITE) {
+            // dfs on the neighbor
+            (*parents)[v] = (int)src;
+            string cycle = isContainsCycleUtil(g, v, colors, parents, path);
+            if (!cycle.empty()) {  // if a cycle is detected
+                return cycle;
+            }
+        } else if ((*colors)[v] == GRAY) {  // if the neighbor is gray, then we have a cycle
+            // if the graph is undirected, we should ignore the edge that connects the current vertex to its parent
+            if (!g.isDirectedGraph() && (*parents)[src] == (int)v) {
+                continue;
             }
+            // construct the cycle path
+            return constructCyclePath(g, *path, (int)v);
         }
     }
     (*colors)[src] = BLACK;  // the vertex is done, mark it as black
@@ -592,11 +1974,12 @@ string isContainsCycleUtil(const Graph& g, size_t src, vector<Color>* colors, ve
 
 /**
  * @brief Build the cycle path from the path vector
+ * @param g - the graph (used to translate the vertices to their original ids)
  * @param path - the path vector - used to store the sequence of vertices visited during the DFS when a cycle is detected
  * @param start - the start/end of the cycle (start == end)
  * @return the cycle path in the format "v1->v2->...->v1"
  */
-string constructCyclePath(vector<int>& path, int start) {
+string constructCyclePath(const Graph& g, vector<int>& path, int start) {
     string cycle;
     size_t v = 0;
     // find the start of the cycle in the path
@@ -607,9 +1990,59 @@ string constructCyclePath(vector<int>& path, int start) {
     }
     // we start from the start of the cycle, until the end of the path (when the cycle is detected)
     for (size_t i = v; i < path.size(); i++) {
-        cycle += std::to_string(path[i]) + "->";
+        cycle += std::to_string(g.toOriginalId((size_t)path[i])) + "->";
     }
 
-    cycle += std::to_string(start);  // to complete the cycle
+    cycle += std::to_string(g.toOriginalId((size_t)start));  // to complete the cycle
     return cycle;
 }
+
+// ~ parallel helpers ~
+
+/**
+ * @brief split the vertices to ranges with about the same number of out-edges (a range can be empty)
+ * @return the bounds of the ranges: range i is [parts[i], parts[i + 1])
+ */
+vector<size_t> edgePartitions(const Graph& g, size_t numParts) {
+    size_t n = g.getNumVertices();
+    size_t totalEdges = 0;
+    for (size_t u = 0; u < n; u++) {
+        totalEdges += g.neighbors(u).size() + 1;  // +1 so the vertices without edges are split too
+    }
+
+    vector<size_t> parts{0};
+    size_t edges = 0;
+    for (size_t u = 0; u < n; u++) {
+        edges += g.neighbors(u).size() + 1;
+        if (edges * numParts >= totalEdges * parts.size() && parts.size() < numParts) {
+            parts.push_back(u + 1);
+        }
+    }
+    parts.push_back(n);
+    return parts;
+}
+
+/**
+ * @brief pack a (distance, parent) label in 64 bits, so comparing the numbers compares the distances first and then the parents
+ */
+uint64_t packLabel(int distance, int parent) {
+    return ((uint64_t)((uint32_t)distance ^ 0x80000000U) << 32) | (uint32_t)parent;
+}
+
+pair<int, int> unpackLabel(uint64_t label) {
+    return {(int)((uint32_t)(label >> 32) ^ 0x80000000U), (int)(uint32_t)label};
+}
+
+/**
+ * @brief target = min(target, value), atomically
+ * @return true if the target was changed
+ */
+bool atomicMin(std::atomic<uint64_t>& target, uint64_t value) {
+    uint64_t current = target.load(std::memory_order_relaxed);
+    while (value < current) {
+        if (target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+    return false;
+}
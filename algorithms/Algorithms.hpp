@@ -2,16 +2,153 @@
  * @author Shay Gali
  * @link shay.gali@msmail.ariel.ac.il
  */
+#pragma once
+
 #include <algorithm>
 #include <iostream>
+#include <stdexcept>
 #include <string>
+#include <type_traits>
+#include <utility>
 
+#include "../graph/CsrGraph.hpp"
 #include "../graph/Graph.hpp"
+#include "Heaps.hpp"
+#include "Heuristics.hpp"
+#include "ThreadPool.hpp"
 
 using std::string;
 namespace shayg {
+
+// the side of a tile of floydWarshall: a 64 x 64 tile of ints is 16KB, so the 3 tiles of an update stay in the L1/L2 cache
+constexpr size_t FLOYD_WARSHALL_BLOCK = 64;
+
 class Algorithms {
    public:
+    /**
+     * @brief the result of a shortest path query
+     */
+    struct ShortestPathResult {
+        enum class Status {
+            FOUND,          // there is a path, `distance` and `path` are set
+            NO_PATH,        // the destination is not reachable from the source
+            NEGATIVE_CYCLE  // the graph contains a negative-weight cycle, so the shortest path is not defined
+        };
+
+        Status status;
+        int distance;         // the length of the path (the number of edges for an unweighted graph). INF if there is no path
+        vector<size_t> path;  // the vertices of the path, from the source to the destination (empty if there is no path)
+    };
+
+    /**
+     * @brief the shortest paths from one source to all the vertices of a graph (the distances and the parents of a single search).
+     * the distances are looked up in O(1), and a path is built only when it is asked for, in O(L).
+     * all the ids are the original ids of the graph (even if the graph was reordered).
+     */
+    class ShortestPathTree {
+       public:
+        ShortestPathTree(size_t source, vector<int> distances, vector<int> parents, bool negativeCycle)
+            : source(source), distances(std::move(distances)), parents(std::move(parents)), negativeCycle(negativeCycle) {}
+
+        size_t getSource() const { return source; }
+        size_t getNumVertices() const { return distances.size(); }
+
+        /**
+         * @brief true if the graph contains a negative-weight cycle (reachable from the source), so the shortest paths are not defined
+         */
+        bool hasNegativeCycle() const { return negativeCycle; }
+
+        /**
+         * @brief check if there is a path from the source to v
+         * @throws std::out_of_range if v is not in the graph
+         */
+        bool isReachable(size_t v) const { return distances.at(v) != INF; }
+
+        /**
+         * @brief the distance from the source to v (the number of edges for an unweighted graph), INF if v is not reachable
+         * @throws std::out_of_range if v is not in the graph
+         * @throws std::runtime_error if the graph contains a negative-weight cycle
+         */
+        int distanceTo(size_t v) const;
+
+        /**
+         * @brief the vertices of the shortest path from the source to v, empty if v is not reachable
+         * @throws std::out_of_range if v is not in the graph
+         * @throws std::runtime_error if the graph contains a negative-weight cycle
+         */
+        vector<size_t> pathTo(size_t v) const;
+
+        /**
+         * @brief the path from the source to v as a ShortestPathResult (the same result findShortestPath returns)
+         * @throws std::out_of_range if v is not in the graph
+         */
+        ShortestPathResult resultTo(size_t v) const;
+
+       private:
+        size_t source;
+        vector<int> distances;
+        vector<int> parents;
+        bool negativeCycle;
+    };
+
+    /**
+     * @brief the shortest paths between all the pairs of vertices (see johnson and floydWarshall).
+     * the distances are one flat |V| x |V| matrix (row u holds the distances from u), and the next hops - the vertex after u
+     * on the shortest path from u to v - are another one, if they were asked for. a path is built from the next hops in O(L).
+     * all the ids are the original ids of the graph (even if the graph was reordered).
+     */
+    class AllPairsResult {
+       public:
+        AllPairsResult(size_t numVertices, vector<int> distances, vector<int> nextHops, bool negativeCycle)
+            : numVertices(numVertices), distances(std::move(distances)), nextHops(std::move(nextHops)), negativeCycle(negativeCycle) {}
+
+        size_t getNumVertices() const { return numVertices; }
+
+        /**
+         * @brief true if the graph contains a negative-weight cycle, so the shortest paths are not defined (and nothing else was computed)
+         */
+        bool hasNegativeCycle() const { return negativeCycle; }
+
+        /**
+         * @brief true if the next hops were computed, so the paths can be built
+         */
+        bool hasNextHops() const { return !negativeCycle && nextHops.size() == distances.size(); }
+
+        /**
+         * @brief the distance matrix, row by row: the distance from u to v is at u * |V| + v (INF if there is no path)
+         */
+        const vector<int>& getDistances() const { return distances; }
+
+        /**
+         * @brief the distance from u to v, INF if there is no path
+         * @throws std::out_of_range if u or v is not in the graph
+         * @throws std::runtime_error if the graph contains a negative-weight cycle
+         */
+        int distance(size_t u, size_t v) const;
+
+        /**
+         * @brief the vertex after u on the shortest path from u to v, -1 if there is no path or u == v
+         * @throws std::out_of_range if u or v is not in the graph
+         * @throws std::logic_error if the next hops were not computed
+         */
+        int nextHop(size_t u, size_t v) const;
+
+        /**
+         * @brief the vertices of the shortest path from u to v, empty if there is no path
+         * @throws std::out_of_range if u or v is not in the graph
+         * @throws std::logic_error if the next hops were not computed
+         */
+        vector<size_t> path(size_t u, size_t v) const;
+
+       private:
+        size_t numVertices;
+        vector<int> distances;
+        vector<int> nextHops;
+        bool negativeCycle;
+
+        size_t index(size_t u, size_t v) const;  // the index of (u, v) in the matrices, or std::out_of_range
+    };
+
     /**
      * @brief Check if the graph is connected
      * @param g - the graph to check
@@ -19,17 +156,172 @@ class Algorithms {
      */
     static bool isConnected(const Graph& g);
 
+    /**
+     * @brief Check if a memory-mapped CSR graph is connected (same definition as for Graph)
+     * @param g - the graph to check
+     * @return true if the graph is connected, false otherwise
+     */
+    static bool isConnected(const MappedCsrGraph& g);
+
+    /**
+     * @brief Check if the graph is strongly connected (every vertex is reachable from every other vertex).
+     * Uses a forward traversal and a reverse traversal over the transposed adjacency list, in O(V+E).
+     * @param g - the graph to check
+     * @return true if the graph is strongly connected, false otherwise. An empty graph is strongly connected.
+     */
+    static bool isStronglyConnected(const Graph& g);
+
     /**
      * @brief Find the shortest path between two vertices
      * @param g - the graph to search in
      * @param src - the source vertex
      * @param dest - the destination vertex
+     * @param policy - the priority queue Dijkstra's algorithm uses (for graphs with non-negative weights)
+     * @param execution - PARALLEL runs the search on the threads of ThreadPool::shared(): delta-stepping for non-negative weights
+     *  (the same distances as Dijkstra, the path may be a different shortest path), and Bellman-Ford in rounds for directed graphs with negative weights
+     * @return ShortestPathResult the status of the query, the distance and the vertices of the path
+     * @throws std::invalid_argument if the source or destination vertices are not in the graph
+     */
+    static ShortestPathResult findShortestPath(const Graph& g, size_t src, size_t dest, QueuePolicy policy = QueuePolicy::AUTO,
+                                               ExecutionPolicy execution = ExecutionPolicy::SEQUENTIAL);
+
+    /**
+     * @brief Find the shortest path between two vertices with a bidirectional search: forward from the source over the out-edges,
+     * and backward from the destination over the in-edges, until the two searches meet.
+     * unweighted graphs use bidirectional BFS, graphs with non-negative weights use bidirectional Dijkstra,
+     * and graphs with negative weights fall back to findShortestPath.
+     * @note the distance is the same as findShortestPath, but when there are several shortest paths, the path may be a different one.
+     * @param g - the graph to search in
+     * @param src - the source vertex
+     * @param dest - the destination vertex
+     * @return ShortestPathResult the status of the query, the distance and the vertices of the path
+     * @throws std::invalid_argument if the source or destination vertices are not in the graph
+     */
+    static ShortestPathResult bidirectionalShortestPath(const Graph& g, size_t src, size_t dest);
+
+    /**
+     * @brief Find the shortest path between two vertices with A*: Dijkstra's algorithm where the queue is ordered by
+     * the distance from the source + the heuristic lower bound of the distance to the destination, so the search goes toward the destination.
+     * @tparam Heuristic - a callable h(v, dest) that returns a lower bound of the distance from v to dest (see Heuristics.hpp).
+     *  it is a template parameter so the calls are inlined.
+     * @param g - the graph to search in
+     * @param src - the source vertex
+     * @param dest - the destination vertex
+     * @param heuristic - the heuristic. without a heuristic (NoHeuristic), or if the graph has negative weights, this is findShortestPath.
+     * @return ShortestPathResult the status of the query, the distance and the vertices of the path
+     * @throws std::invalid_argument if the source or destination vertices are not in the graph
+     */
+    template <typename Heuristic = NoHeuristic>
+    static ShortestPathResult aStar(const Graph& g, size_t src, size_t dest, const Heuristic& heuristic = Heuristic());
+
+    /**
+     * @brief Find the shortest paths from a source to all the vertices with a single search
+     * (BFS, Dijkstra or Bellman-Ford, chosen the same way as in findShortestPath)
+     * @param g - the graph to search in
+     * @param src - the source vertex
+     * @param policy - the priority queue Dijkstra's algorithm uses (for graphs with non-negative weights)
+     * @param execution - run the search on the calling thread or on the thread pool (see findShortestPath)
+     * @return ShortestPathTree the distances and the paths to all the vertices
+     * @throws std::invalid_argument if the source vertex is not in the graph, or if the graph is undirected and has negative weights
+     *  (findShortestPath also searches from the destination there, so no single tree gives its answers)
+     */
+    static ShortestPathTree shortestPathTree(const Graph& g, size_t src, QueuePolicy policy = QueuePolicy::AUTO,
+                                             ExecutionPolicy execution = ExecutionPolicy::SEQUENTIAL);
+
+    /**
+     * @brief Find the shortest paths between all the pairs of vertices with Johnson's algorithm.
+     * if the graph has negative weights, one Bellman-Ford from all the vertices at once (as from a virtual source connected to all of them)
+     * gives every vertex a potential h, and the edges are reweighted to w(u, v) + h(u) - h(v) >= 0. then Dijkstra runs to every vertex
+     * (over the reversed edges, so the next hops toward a vertex are one tree and the paths they make never loop),
+     * in O(V * E log V) in total instead of the O(V^3) of Floyd-Warshall on a sparse graph.
+     * @note when there are several shortest paths, the path may be a different one than findShortestPath's.
+     * @param g - the graph to search in
+     * @param withNextHops - also compute the next hops, so the paths can be built (another |V| x |V| matrix)
+     * @param execution - PARALLEL splits the Dijkstra runs between the threads of ThreadPool::shared(), each thread with its own queue
+     * @return AllPairsResult the distance matrix, and the next hops if they were asked for
+     * @throws std::invalid_argument if the graph is undirected and has negative weights (every negative edge is a negative cycle)
+     */
+    static AllPairsResult johnson(const Graph& g, bool withNextHops = false, ExecutionPolicy execution = ExecutionPolicy::PARALLEL);
+
+    /**
+     * @brief Find the shortest paths between all the pairs of vertices with Floyd-Warshall, for dense graphs.
+     * the adjacency matrix is copied to one flat matrix (NO_EDGE is INF), and the matrix is updated in tiles of
+     * FLOYD_WARSHALL_BLOCK x FLOYD_WARSHALL_BLOCK in 3 phases for every diagonal tile: the diagonal tile, then the tiles in its row and column,
+     * then all the other tiles. the tiles of a phase are independent, and the inner loop is a min/add over a row of a tile that the compiler vectorizes.
+     * @param g - the graph to search in
+     * @param withNextHops - also compute the successor matrix (the next hops), so the paths can be built
+     * @param execution - PARALLEL updates the tiles of a phase on the threads of ThreadPool::shared()
+     * @return AllPairsResult the distance matrix, and the next hops if they were asked for (see johnson)
+     * @throws std::invalid_argument if the graph is undirected and has negative weights (every negative edge is a negative cycle)
+     */
+    static AllPairsResult floydWarshall(const Graph& g, bool withNextHops = false, ExecutionPolicy execution = ExecutionPolicy::PARALLEL);
+
+    /**
+     * @brief Find the shortest path between two vertices, formatted as a string (see findShortestPath)
+     * @param g - the graph to search in
+     * @param src - the source vertex
+     * @param dest - the destination vertex
+     * @param execution - run the search on the calling thread or on the thread pool (see findShortestPath)
      * @return the shortest path between the source and destination vertices in the format "src->...->dest".
-     *  if there is no path between the source and destination vertices, return "-1"
-     * @throws NegativeCycleException if the graph contains a negative-weight cycle
+     *  if there is no path between the source and destination vertices, return "-1".
+     *  if the graph contains a negative-weight cycle, return "Graph contains a negative-weight cycle".
      * @throws std::invalid_argument if the source or destination vertices are not in the graph
      */
-    static string shortestPath(const Graph& g, size_t src, size_t dest);
+    static string shortestPath(const Graph& g, size_t src, size_t dest, ExecutionPolicy execution = ExecutionPolicy::SEQUENTIAL);
+
+    /**
+     * @brief Find the shortest paths of a batch of (src, dest) queries.
+     * the queries are grouped by source, so every distinct source runs one search (the same as shortestPathTree),
+     * and the paths of all its queries are taken from that search.
+     * an undirected graph with negative weights has no single tree per source (findShortestPath also searches from the destination),
+     *  so there every query runs findShortestPath.
+     * @param g - the graph to search in
+     * @param queries - the (src, dest) pairs
+     * @param execution - PARALLEL runs the searches of different sources on the threads of ThreadPool::shared(), each with its own buffers
+     *  (with a single source, the search itself runs in parallel, see findShortestPath)
+     * @return the results of the queries, in the order of the queries (the same results as findShortestPath)
+     * @throws std::invalid_argument if a source or destination vertex is not in the graph (before any search runs)
+     */
+    static vector<ShortestPathResult> findShortestPaths(const Graph& g, const vector<std::pair<size_t, size_t>>& queries,
+                                                        ExecutionPolicy execution = ExecutionPolicy::PARALLEL);
+
+    /**
+     * @brief Find the shortest paths of a batch of (src, dest) queries, formatted as strings (see findShortestPaths and shortestPath)
+     */
+    static vector<string> shortestPaths(const Graph& g, const vector<std::pair<size_t, size_t>>& queries,
+                                        ExecutionPolicy execution = ExecutionPolicy::PARALLEL);
+
+    /**
+     * @brief Find the number of edges (hops) from many sources to all the vertices, with a bit-parallel multi-source BFS (MS-BFS).
+     * the sources run in batches of 64: every vertex keeps a 64-bit mask of the searches that already reached it and of the searches
+     * whose frontier is at it, so one scan of the out-edges of a vertex advances all the searches of the batch. the weights are ignored.
+     * @param g - the graph to search in
+     * @param sources - the sources (may repeat)
+     * @param execution - PARALLEL runs the batches on the threads of ThreadPool::shared()
+     * @return row i holds the number of edges from sources[i] to every vertex (INF if the vertex is not reachable)
+     * @throws std::invalid_argument if a source is not in the graph
+     */
+    static vector<vector<int>> multiSourceBfs(const Graph& g, const vector<size_t>& sources, ExecutionPolicy execution = ExecutionPolicy::PARALLEL);
+
+    /**
+     * @brief Find the shortest path between two vertices of an unweighted memory-mapped CSR graph (with BFS)
+     * @param g - the graph to search in
+     * @param src - the source vertex
+     * @param dest - the destination vertex
+     * @return ShortestPathResult the status of the query, the distance and the vertices of the path
+     * @throws std::invalid_argument if the source or destination vertices are not in the graph, or if the graph is weighted
+     */
+    static ShortestPathResult findShortestPath(const MappedCsrGraph& g, size_t src, size_t dest);
+
+    /**
+     * @brief Find the shortest path between two vertices of an unweighted memory-mapped CSR graph (with BFS)
+     * @param g - the graph to search in
+     * @param src - the source vertex
+     * @param dest - the destination vertex
+     * @return the shortest path in the format "src->...->dest", or "-1" if there is no path
+     * @throws std::invalid_argument if the source or destination vertices are not in the graph, or if the graph is weighted
+     */
+    static string shortestPath(const MappedCsrGraph& g, size_t src, size_t dest);
 
     /**
      * @brief Check if the graph contains a cycle. If the graph contains a cycle, return the cycle in the format "v1->v2->...->v1".
@@ -55,6 +347,13 @@ class Algorithms {
      */
     static string negativeCycle(const Graph& g);
 
+    /**
+     * @brief Format a shortest path result the same way shortestPath does
+     * @param result - the result of findShortestPath
+     * @return "src->...->dest", "-1" if there is no path, or "Graph contains a negative-weight cycle"
+     */
+    static string formatPath(const ShortestPathResult& result);
+
     class NegativeCycleException : public std::exception {
        public:
         vector<size_t> cycle;
@@ -86,4 +385,51 @@ class Algorithms {
         }
     };
 };
+
+template <typename Heuristic>
+Algorithms::ShortestPathResult Algorithms::aStar(const Graph& g, size_t src, size_t dest, const Heuristic& heuristic) {
+    if (src >= g.getNumVertices() || dest >= g.getNumVertices()) {
+        throw std::invalid_argument("Invalid source or destination vertex");
+    }
+    if constexpr (std::is_same_v<Heuristic, NoHeuristic>) {
+        return findShortestPath(g, src, dest);
+    } else {
+        if (src == dest || g.isHaveNegativeEdgeWeight()) {  // A* needs non-negative weights
+            return findShortestPath(g, src, dest);
+        }
+
+        // the search works with the internal ids, the heuristic gets the original ids
+        size_t n = g.getNumVertices();
+        size_t from = g.toInternalId(src);
+        size_t to = g.toInternalId(dest);
+        vector<int> distances(n, INF);
+        vector<int> parents(n, -1);
+        IndexedDaryHeap<4> open(n);  // the key of a vertex is its distance + the heuristic
+
+        distances[from] = 0;
+        open.push(from, heuristic(src, dest));
+        while (!open.empty()) {
+            size_t u = open.pop().second;
+            if (u == to) {  // with an admissible heuristic, the distance to the destination is final when it is popped
+                ShortestPathResult result{ShortestPathResult::Status::FOUND, distances[to], {}};
+                for (int v = (int)to; v != -1; v = parents[(size_t)v]) {
+                    result.path.push_back(g.toOriginalId((size_t)v));
+                }
+                std::reverse(result.path.begin(), result.path.end());
+                return result;
+            }
+
+            for (auto [v, w] : g.neighbors(u)) {
+                int currDist = distances[u] + w;
+                if (currDist < distances[v]) {  // a vertex that was already popped is opened again if we find a shorter path to it
+                    distances[v] = currDist;
+                    parents[v] = (int)u;
+                    open.push(v, currDist + heuristic(g.toOriginalId(v), dest));
+                }
+            }
+        }
+        return {ShortestPathResult::Status::NO_PATH, INF, {}};
+    }
+}
+
 }  // namespace shayg
\ No newline at end of file
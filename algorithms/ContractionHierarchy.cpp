@@ -0,0 +1,351 @@
+/**
+ * @author Shay Gali
+ * @link shay.gali@msmail.ariel.ac.il
+ */
+#include "ContractionHierarchy.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <queue>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+using namespace shayg;
+
+using std::pair;
+using std::priority_queue;
+
+// a witness search gives up (and the shortcut is added) after settling this many vertices
+constexpr size_t WITNESS_SETTLE_LIMIT = 500;
+// the number of labels a query reserves for each search (the search spaces of the queries are small)
+constexpr size_t QUERY_RESERVE = 256;
+
+// ~~~ declare the helper functions ~~~
+
+/**
+ * @brief the graph that is left during the contraction: the edges (and shortcuts) between the vertices that were not contracted yet
+ */
+struct ContractionGraph {
+    struct Edge {
+        size_t to;
+        int weight;
+        int middle;  // the contracted vertex of a shortcut, -1 for an edge of the graph
+    };
+
+    struct Shortcut {
+        size_t from;
+        size_t to;
+        int weight;
+    };
+
+    explicit ContractionGraph(const Graph& g);
+
+    /**
+     * @brief add the edge u -> w, or make the existing one shorter
+     * @return true if the edge was added or changed
+     */
+    bool addEdge(size_t u, size_t w, int weight, int middle);
+
+    /**
+     * @brief the shortcuts that are needed to contract v: u -> v -> w when the witness search finds no path from u to w
+     * (that does not go through v) that is as short
+     */
+    vector<Shortcut> shortcutsOf(size_t v);
+
+    /**
+     * @brief the edge difference of v (plus the number of neighbors that were contracted, to spread the contractions over the graph)
+     */
+    int priorityOf(size_t v, size_t numShortcuts) const;
+
+    /**
+     * @brief remove v and its edges, and add the shortcuts
+     * @return the number of shortcuts that were added
+     */
+    size_t contract(size_t v, const vector<Shortcut>& shortcuts);
+
+    /**
+     * @brief Dijkstra from src that does not go through skip, and stops at distance limit
+     * (or after WITNESS_SETTLE_LIMIT vertices). the distances are left in `distances`.
+     */
+    void witnessSearch(size_t src, size_t skip, int limit);
+
+    vector<vector<Edge>> out;  // out[u] - the edges u -> w
+    vector<vector<Edge>> in;   // in[w] - the edges u -> w (`to` is u)
+    vector<size_t> contractedNeighbors;
+    vector<int> distances;  // the distances of the last witness search (INF for the vertices it did not reach)
+    vector<size_t> touched;  // the vertices the last witness search reached
+    size_t numWitnessSearches = 0;
+};
+
+// ~~~ implement the functions ~~~
+
+ContractionHierarchy::ContractionHierarchy(const Graph& g) : revision(g.getRevision()) {
+    if (g.isHaveNegativeEdgeWeight()) {
+        throw std::invalid_argument("Contraction hierarchies need non-negative weights.");
+    }
+    auto start = std::chrono::steady_clock::now();
+
+    size_t n = g.getNumVertices();
+    ContractionGraph remaining(g);
+    ranks.assign(n, 0);
+    upward.assign(n, {});
+    downward.assign(n, {});
+
+    // contract the vertex with the lowest priority. the priorities change when the neighbors are contracted,
+    // so the priority of the top vertex is computed again, and if it is no longer the lowest the vertex goes back to the queue (lazy updates)
+    priority_queue<pair<int, size_t>, vector<pair<int, size_t>>, std::greater<>> order;
+    for (size_t v = 0; v < n; v++) {
+        order.emplace(remaining.priorityOf(v, remaining.shortcutsOf(v).size()), v);
+    }
+
+    size_t rank = 0;
+    while (!order.empty()) {
+        size_t v = order.top().second;
+        order.pop();
+
+        vector<ContractionGraph::Shortcut> shortcuts = remaining.shortcutsOf(v);
+        int priority = remaining.priorityOf(v, shortcuts.size());
+        if (!order.empty() && priority > order.top().first) {
+            order.emplace(priority, v);
+            continue;
+        }
+
+        // the edges that are left go to vertices that will be contracted later (higher ranks)
+        ranks[v] = rank++;
+        for (const ContractionGraph::Edge& e : remaining.out[v]) {
+            upward[v].push_back({e.to, e.weight, e.middle});
+        }
+        for (const ContractionGraph::Edge& e : remaining.in[v]) {
+            downward[v].push_back({e.to, e.weight, e.middle});
+        }
+        buildStats.numUpwardEdges += upward[v].size() + downward[v].size();
+        buildStats.numShortcuts += remaining.contract(v, shortcuts);
+    }
+
+    buildStats.numWitnessSearches = remaining.numWitnessSearches;
+    buildStats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+Algorithms::ShortestPathResult ContractionHierarchy::query(size_t src, size_t dest, QueryStats* stats) const {
+    size_t n = getNumVertices();
+    if (src >= n || dest >= n) {
+        throw std::invalid_argument("Invalid source or destination vertex");
+    }
+    auto start = std::chrono::steady_clock::now();
+    QueryStats queryStats;
+
+    // the labels of the two searches (only the vertices the searches reach, so a query does not pay O(V))
+    struct Label {
+        int distance;
+        size_t parent;  // the previous vertex in the search (n for the source of the search)
+        size_t arc;     // the index of the arc from the parent, in upward[parent] (forward) or downward[parent] (backward)
+    };
+    using Queue = priority_queue<pair<int, size_t>, vector<pair<int, size_t>>, std::greater<>>;
+    std::unordered_map<size_t, Label> labels[2];  // 0 - forward from src, 1 - backward from dest
+    Queue queues[2];
+    labels[0].reserve(QUERY_RESERVE);
+    labels[1].reserve(QUERY_RESERVE);
+    labels[0][src] = {0, n, 0};
+    labels[1][dest] = {0, n, 0};
+    queues[0].emplace(0, src);
+    queues[1].emplace(0, dest);
+
+    int best = INF;
+    size_t meeting = n;
+    while (true) {
+        // a search can stop when its next distance is not shorter than the best path found
+        bool forwardDone = queues[0].empty() || queues[0].top().first >= best;
+        bool backwardDone = queues[1].empty() || queues[1].top().first >= best;
+        if (forwardDone && backwardDone) {
+            break;
+        }
+        size_t side = forwardDone || (!backwardDone && queues[1].top().first < queues[0].top().first) ? 1 : 0;
+
+        auto [distance, u] = queues[side].top();
+        queues[side].pop();
+        if (distance > labels[side][u].distance) {
+            continue;  // an old entry of a vertex that was already settled
+        }
+        queryStats.settledVertices++;
+
+        auto other = labels[1 - side].find(u);
+        if (other != labels[1 - side].end() && distance + other->second.distance < best) {
+            best = distance + other->second.distance;
+            meeting = u;
+        }
+
+        const vector<Arc>& arcs = side == 0 ? upward[u] : downward[u];
+        for (size_t i = 0; i < arcs.size(); i++) {
+            queryStats.relaxedEdges++;
+            int currDist = distance + arcs[i].weight;
+            auto [label, inserted] = labels[side].try_emplace(arcs[i].to, Label{currDist, u, i});
+            if (inserted || currDist < label->second.distance) {
+                label->second = {currDist, u, i};
+                queues[side].emplace(currDist, arcs[i].to);
+            }
+        }
+    }
+
+    Algorithms::ShortestPathResult result{Algorithms::ShortestPathResult::Status::NO_PATH, INF, {}};
+    if (meeting != n) {
+        result.status = Algorithms::ShortestPathResult::Status::FOUND;
+        result.distance = best;
+
+        // the arcs from src up to the meeting vertex (collected backwards)
+        vector<pair<size_t, Arc>> arcs;
+        for (size_t v = meeting; v != src;) {
+            const Label& label = labels[0].at(v);
+            arcs.emplace_back(label.parent, upward[label.parent][label.arc]);
+            v = label.parent;
+        }
+        std::reverse(arcs.begin(), arcs.end());
+        // the arcs from the meeting vertex down to dest. the arc in downward[parent] is the edge v -> parent
+        for (size_t v = meeting; v != dest;) {
+            const Label& label = labels[1].at(v);
+            const Arc& arc = downward[label.parent][label.arc];
+            arcs.emplace_back(v, Arc{label.parent, arc.weight, arc.middle});
+            v = label.parent;
+        }
+
+        result.path.push_back(src);
+        for (const auto& [from, arc] : arcs) {
+            unpack(from, arc, result.path, queryStats.unpackedShortcuts);
+        }
+    }
+
+    if (stats != nullptr) {
+        queryStats.microseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        *stats = queryStats;
+    }
+    return result;
+}
+
+void ContractionHierarchy::unpack(size_t from, const Arc& arc, vector<size_t>& path, size_t& unpackedShortcuts) const {
+    // a shortcut from -> to that skips m is the arcs from -> m (in downward[m]) and m -> to (in upward[m])
+    vector<pair<size_t, Arc>> stack{{from, arc}};
+    while (!stack.empty()) {
+        auto [u, current] = stack.back();
+        stack.pop_back();
+        if (current.middle == -1) {
+            path.push_back(current.to);
+            continue;
+        }
+
+        unpackedShortcuts++;
+        auto middle = (size_t)current.middle;
+        auto toMiddle = std::find_if(downward[middle].begin(), downward[middle].end(), [u = u](const Arc& a) { return a.to == u; });
+        auto fromMiddle = std::find_if(upward[middle].begin(), upward[middle].end(), [&current](const Arc& a) { return a.to == current.to; });
+        stack.emplace_back(middle, *fromMiddle);  // the second half is unpacked after the first
+        stack.emplace_back(u, Arc{middle, toMiddle->weight, toMiddle->middle});
+    }
+}
+
+// ~~~ implement the helper functions ~~~
+
+ContractionGraph::ContractionGraph(const Graph& g)
+    : out(g.getNumVertices()), in(g.getNumVertices()), contractedNeighbors(g.getNumVertices(), 0), distances(g.getNumVertices(), INF) {
+    for (size_t u = 0; u < g.getNumVertices(); u++) {
+        for (auto [v, w] : g.neighbors(u)) {
+            if (u != v) {
+                addEdge(g.toOriginalId(u), g.toOriginalId(v), w, -1);
+            }
+        }
+    }
+}
+
+bool ContractionGraph::addEdge(size_t u, size_t w, int weight, int middle) {
+    auto existing = std::find_if(out[u].begin(), out[u].end(), [w](const Edge& e) { return e.to == w; });
+    if (existing == out[u].end()) {
+        out[u].push_back({w, weight, middle});
+        in[w].push_back({u, weight, middle});
+        return true;
+    }
+    if (weight >= existing->weight) {
+        return false;
+    }
+    *existing = {w, weight, middle};
+    *std::find_if(in[w].begin(), in[w].end(), [u](const Edge& e) { return e.to == u; }) = {u, weight, middle};
+    return true;
+}
+
+vector<ContractionGraph::Shortcut> ContractionGraph::shortcutsOf(size_t v) {
+    vector<Shortcut> shortcuts;
+    int maxOut = 0;
+    for (const Edge& e : out[v]) {
+        maxOut = std::max(maxOut, e.weight);
+    }
+
+    for (const Edge& inEdge : in[v]) {
+        size_t u = inEdge.to;
+        witnessSearch(u, v, inEdge.weight + maxOut);
+        for (const Edge& outEdge : out[v]) {
+            int viaV = inEdge.weight + outEdge.weight;
+            if (outEdge.to != u && distances[outEdge.to] > viaV) {
+                shortcuts.push_back({u, outEdge.to, viaV});
+            }
+        }
+    }
+    return shortcuts;
+}
+
+int ContractionGraph::priorityOf(size_t v, size_t numShortcuts) const {
+    return (int)numShortcuts - (int)(in[v].size() + out[v].size()) + (int)contractedNeighbors[v];
+}
+
+size_t ContractionGraph::contract(size_t v, const vector<Shortcut>& shortcuts) {
+    for (const Edge& e : out[v]) {
+        in[e.to].erase(std::find_if(in[e.to].begin(), in[e.to].end(), [v](const Edge& back) { return back.to == v; }));
+        contractedNeighbors[e.to]++;
+    }
+    for (const Edge& e : in[v]) {
+        out[e.to].erase(std::find_if(out[e.to].begin(), out[e.to].end(), [v](const Edge& forward) { return forward.to == v; }));
+        contractedNeighbors[e.to]++;
+    }
+    out[v].clear();
+    in[v].clear();
+
+    size_t added = 0;
+    for (const Shortcut& s : shortcuts) {
+        if (addEdge(s.from, s.to, s.weight, (int)v)) {
+            added++;
+        }
+    }
+    return added;
+}
+
+void ContractionGraph::witnessSearch(size_t src, size_t skip, int limit) {
+    numWitnessSearches++;
+    for (size_t v : touched) {
+        distances[v] = INF;
+    }
+    touched.clear();
+
+    priority_queue<pair<int, size_t>, vector<pair<int, size_t>>, std::greater<>> pq;
+    distances[src] = 0;
+    touched.push_back(src);
+    pq.emplace(0, src);
+    size_t settled = 0;
+    while (!pq.empty() && settled < WITNESS_SETTLE_LIMIT) {
+        auto [distance, u] = pq.top();
+        pq.pop();
+        if (distance > distances[u]) {
+            continue;
+        }
+        if (distance > limit) {
+            break;
+        }
+        settled++;
+        for (const Edge& e : out[u]) {
+            int currDist = distance + e.weight;
+            if (e.to != skip && currDist < distances[e.to]) {
+                if (distances[e.to] == INF) {
+                    touched.push_back(e.to);
+                }
+                distances[e.to] = currDist;
+                pq.emplace(currDist, e.to);
+            }
+        }
+    }
+}
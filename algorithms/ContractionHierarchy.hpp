@@ -0,0 +1,113 @@
+/**
+ * @author Shay Gali
+ * @link shay.gali@msmail.ariel.ac.il
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../graph/Graph.hpp"
+#include "Algorithms.hpp"
+
+using std::string;
+using std::vector;
+
+namespace shayg {
+
+/**
+ * @brief Contraction Hierarchies - preprocessing for fast shortest path queries on large sparse graphs (like road networks).
+ *
+ * The vertices are contracted one by one, in the order of their edge difference (the number of shortcuts the contraction adds
+ * minus the number of edges it removes, plus the number of neighbors that were already contracted). When a vertex is contracted,
+ * a shortcut u->w is added for every path u->v->w that is the only shortest path between u and w (a local Dijkstra, the witness search, looks for another one).
+ * A query is a bidirectional Dijkstra that only goes up in the order, and the shortcuts of the path are unpacked back to the edges of the graph.
+ *
+ * The hierarchy is built from a copy of the edges, so the graph can be changed or destroyed later, but then the hierarchy
+ * belongs to the old graph (isValidFor). All the vertices are the original ids of the graph.
+ */
+class ContractionHierarchy {
+   public:
+    /**
+     * @brief statistics of the preprocessing
+     */
+    struct BuildStats {
+        size_t numShortcuts = 0;        // the number of shortcuts that were added
+        size_t numWitnessSearches = 0;  // the number of local Dijkstra searches (for the priorities and the contractions)
+        size_t numUpwardEdges = 0;      // the number of edges (and shortcuts) that are kept for the queries
+        double milliseconds = 0;        // the time the preprocessing took
+    };
+
+    /**
+     * @brief statistics of a single query
+     */
+    struct QueryStats {
+        size_t settledVertices = 0;   // the number of vertices that were settled by both searches
+        size_t relaxedEdges = 0;      // the number of edges that were relaxed by both searches
+        size_t unpackedShortcuts = 0; // the number of shortcuts that were unpacked to build the path
+        double microseconds = 0;      // the time the query took
+    };
+
+    /**
+     * @brief Contract all the vertices of the graph
+     * @param g the graph (the weights must be non-negative)
+     * @throw invalid_argument if the graph has negative weights
+     */
+    explicit ContractionHierarchy(const Graph& g);
+
+    /**
+     * @brief Find the shortest path between two vertices
+     * @param src the source vertex
+     * @param dest the destination vertex
+     * @param stats if not null, the statistics of the query are written to it
+     * @return ShortestPathResult FOUND with the distance and the unpacked path, or NO_PATH
+     * @throw invalid_argument if the source or destination vertices are not in the graph
+     * @note the distance is the same as Algorithms::findShortestPath, and so is the path when the shortest path is unique
+     * (when there are several shortest paths, the path may be a different one).
+     */
+    Algorithms::ShortestPathResult query(size_t src, size_t dest, QueryStats* stats = nullptr) const;
+
+    /**
+     * @brief Find the shortest path between two vertices, formatted like Algorithms::shortestPath ("src->...->dest" or "-1")
+     */
+    string shortestPath(size_t src, size_t dest) const { return Algorithms::formatPath(query(src, dest)); }
+
+    /**
+     * @brief check if the hierarchy was built from this graph, and the graph did not change since
+     */
+    bool isValidFor(const Graph& g) const { return g.getRevision() == revision; }
+
+    size_t getNumVertices() const { return ranks.size(); }
+
+    /**
+     * @brief the position of the vertex in the contraction order (0 is the first vertex that was contracted)
+     */
+    size_t getRank(size_t v) const { return ranks[v]; }
+
+    const BuildStats& getBuildStats() const { return buildStats; }
+
+   private:
+    /**
+     * @brief an edge of the hierarchy, always to a vertex with a higher rank.
+     * a shortcut remembers the vertex it skips, so it can be unpacked to the two edges it replaces.
+     */
+    struct Arc {
+        size_t to;
+        int weight;
+        int middle;  // the contracted vertex of a shortcut, -1 for an edge of the graph
+    };
+
+    /**
+     * @brief append the edges of the arc from -> to (with the shortcuts unpacked) to the path
+     */
+    void unpack(size_t from, const Arc& arc, vector<size_t>& path, size_t& unpackedShortcuts) const;
+
+    vector<size_t> ranks;
+    vector<vector<Arc>> upward;    // upward[u] - the arcs u -> v where rank[v] > rank[u]
+    vector<vector<Arc>> downward;  // downward[v] - the arcs u -> v where rank[u] > rank[v] (`to` is u)
+    BuildStats buildStats;
+    uint64_t revision;  // the revision of the graph the hierarchy was built from
+};
+
+}  // namespace shayg
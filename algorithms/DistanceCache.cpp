@@ -0,0 +1,141 @@
+/**
+ * @author Shay Gali
+ * @link shay.gali@msmail.ariel.ac.il
+ */
+#include "DistanceCache.hpp"
+
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+using namespace shayg;
+using std::vector;
+
+Algorithms::ShortestPathResult DistanceCache::findShortestPath(size_t src, size_t dest) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (src >= g.getNumVertices() || dest >= g.getNumVertices()) {
+        throw std::invalid_argument("Invalid source or destination vertex");
+    }
+    if (src == dest) {  // the same as findShortestPath, without a search
+        return {Algorithms::ShortestPathResult::Status::FOUND, 0, {src}};
+    }
+    if (!hasTrees()) {
+        checkRevision();  // the trees of the graph before the change are not used any more
+        return Algorithms::findShortestPath(g, src, dest);
+    }
+    return tree(src).resultTo(dest);
+}
+
+string DistanceCache::shortestPath(size_t src, size_t dest) {
+    return Algorithms::formatPath(findShortestPath(src, dest));
+}
+
+int DistanceCache::distance(size_t src, size_t dest) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (src >= g.getNumVertices() || dest >= g.getNumVertices()) {
+        throw std::invalid_argument("Invalid source or destination vertex");
+    }
+    if (src == dest) {
+        return 0;
+    }
+    if (!hasTrees()) {
+        checkRevision();
+        Algorithms::ShortestPathResult result = Algorithms::findShortestPath(g, src, dest);
+        if (result.status == Algorithms::ShortestPathResult::Status::NEGATIVE_CYCLE) {
+            throw std::runtime_error("Graph contains a negative-weight cycle");
+        }
+        return result.distance;
+    }
+    return tree(src).distanceTo(dest);
+}
+
+void DistanceCache::precompute(ExecutionPolicy execution) {
+    std::lock_guard<std::mutex> lock(mutex);
+    checkRevision();
+    if (!hasTrees()) {
+        return;
+    }
+    size_t n = g.getNumVertices();
+    if (n > getCapacity()) {
+        throw std::length_error("The trees of all the vertices don't fit in the memory budget");
+    }
+
+    vector<size_t> sources;
+    for (size_t src = 0; src < n; src++) {
+        if (trees.find(src) == trees.end()) {
+            sources.push_back(src);
+        }
+    }
+
+    // one search per task, every search on the thread that runs it
+    vector<std::optional<Algorithms::ShortestPathTree>> computed(sources.size());
+    auto task = [&](size_t i) { computed[i] = Algorithms::shortestPathTree(g, sources[i]); };
+    if (execution == ExecutionPolicy::PARALLEL) {
+        ThreadPool::shared().run(sources.size(), task);
+    } else {
+        for (size_t i = 0; i < sources.size(); i++) {
+            task(i);
+        }
+    }
+
+    for (size_t i = 0; i < sources.size(); i++) {
+        lru.push_front(sources[i]);
+        trees.emplace(sources[i], Entry(std::move(*computed[i]), lru.begin()));
+    }
+    stats.misses += sources.size();
+}
+
+void DistanceCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    trees.clear();
+    lru.clear();
+}
+
+size_t DistanceCache::getTreeBytes() const {
+    // a distance and a parent for every vertex, and the nodes of the map and the list
+    return 2 * g.getNumVertices() * sizeof(int) + sizeof(Entry) + 4 * sizeof(void*);
+}
+
+size_t DistanceCache::getNumTrees() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return trees.size();
+}
+
+DistanceCache::Stats DistanceCache::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+const Algorithms::ShortestPathTree& DistanceCache::tree(size_t src) {
+    checkRevision();
+
+    auto it = trees.find(src);
+    if (it != trees.end()) {
+        stats.hits++;
+        lru.splice(lru.begin(), lru, it->second.second);  // move src to the front
+        return it->second.first;
+    }
+
+    stats.misses++;
+    Algorithms::ShortestPathTree computed = Algorithms::shortestPathTree(g, src);
+    size_t capacity = getCapacity();
+    while (trees.size() >= capacity) {
+        trees.erase(lru.back());
+        lru.pop_back();
+        stats.evictions++;
+    }
+    lru.push_front(src);
+    return trees.emplace(src, Entry(std::move(computed), lru.begin())).first->second.first;
+}
+
+void DistanceCache::checkRevision() {
+    if (g.getRevision() == revision) {
+        return;
+    }
+    if (!trees.empty()) {
+        stats.invalidations++;
+    }
+    trees.clear();
+    lru.clear();
+    revision = g.getRevision();
+}
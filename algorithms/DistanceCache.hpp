@@ -0,0 +1,126 @@
+/**
+ * @author Shay Gali
+ * @link shay.gali@msmail.ariel.ac.il
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "../graph/Graph.hpp"
+#include "Algorithms.hpp"
+#include "ThreadPool.hpp"
+
+using std::string;
+
+namespace shayg {
+
+/**
+ * @brief An opt-in cache of shortest path trees for repeated queries on the same graph.
+ *
+ * The first query from a source runs one search (Algorithms::shortestPathTree) and keeps the tree, so the next queries from the
+ * same source are O(1) for the distance and O(L) for the path, with the same results as Algorithms::findShortestPath.
+ * The trees are evicted in LRU order when the memory budget is full. For a small graph the trees of all the vertices fit in
+ * the budget, and precompute() builds them all at once (an all-pairs table with the same paths as Algorithms::shortestPath).
+ * An undirected graph with negative weights has no single tree per source (Algorithms::findShortestPath also searches from the
+ * destination), so for such a graph nothing is cached and every query runs Algorithms::findShortestPath.
+ *
+ * The cache is attached to one graph, which must outlive it. Every query checks Graph::getRevision, so after any change of the graph
+ * (loadGraph, reorder, the operators) the trees are dropped and computed again. The queries can be called from several threads.
+ */
+class DistanceCache {
+   public:
+    static constexpr size_t DEFAULT_MEMORY_BUDGET = size_t(64) << 20;  // 64MB
+
+    /**
+     * @brief the counters of the cache, since it was created
+     */
+    struct Stats {
+        size_t hits = 0;           // queries that found the tree of the source in the cache
+        size_t misses = 0;         // queries that had to compute the tree of the source
+        size_t evictions = 0;      // trees that were dropped to stay in the memory budget
+        size_t invalidations = 0;  // times the graph changed and all the trees were dropped
+    };
+
+    /**
+     * @param g the graph the cache is attached to
+     * @param memoryBudget the bytes the trees may use (at least one tree is always kept)
+     */
+    explicit DistanceCache(const Graph& g, size_t memoryBudget = DEFAULT_MEMORY_BUDGET) : g(g), memoryBudget(memoryBudget) {}
+
+    DistanceCache(const DistanceCache&) = delete;
+    DistanceCache& operator=(const DistanceCache&) = delete;
+
+    /**
+     * @brief Find the shortest path between two vertices (see Algorithms::findShortestPath)
+     * @throws std::invalid_argument if the source or destination vertices are not in the graph
+     */
+    Algorithms::ShortestPathResult findShortestPath(size_t src, size_t dest);
+
+    /**
+     * @brief Find the shortest path between two vertices, formatted as a string (see Algorithms::shortestPath)
+     * @throws std::invalid_argument if the source or destination vertices are not in the graph
+     */
+    string shortestPath(size_t src, size_t dest);
+
+    /**
+     * @brief the distance from src to dest, INF if there is no path
+     * @throws std::invalid_argument if the source or destination vertices are not in the graph
+     * @throws std::runtime_error if there is a negative-weight cycle that is reachable from src
+     */
+    int distance(size_t src, size_t dest);
+
+    /**
+     * @brief compute the trees of all the vertices that are not cached yet, on the threads of ThreadPool::shared() with PARALLEL
+     *  (nothing for an undirected graph with negative weights)
+     * @throws std::length_error if the trees of all the vertices don't fit in the memory budget
+     */
+    void precompute(ExecutionPolicy execution = ExecutionPolicy::PARALLEL);
+
+    /**
+     * @brief drop all the trees
+     */
+    void clear();
+
+    /**
+     * @brief the bytes one tree of the current graph takes in the cache
+     */
+    size_t getTreeBytes() const;
+
+    /**
+     * @brief the number of trees that fit in the memory budget for the current graph
+     */
+    size_t getCapacity() const { return std::max<size_t>(memoryBudget / getTreeBytes(), 1); }
+
+    size_t getNumTrees() const;
+    size_t getMemoryBudget() const { return memoryBudget; }
+    Stats getStats() const;
+
+   private:
+    // the tree of src, from the cache or computed now. the caller holds the lock
+    const Algorithms::ShortestPathTree& tree(size_t src);
+
+    // drop the trees if the graph changed since they were computed. the caller holds the lock
+    void checkRevision();
+
+    // false if the graph is undirected and has negative weights: the queries don't use the trees then
+    bool hasTrees() const { return g.isDirectedGraph() || !g.isHaveNegativeEdgeWeight(); }
+
+    // the trees of the sources that were used last are at the front of the LRU list
+    using Entry = std::pair<Algorithms::ShortestPathTree, std::list<size_t>::iterator>;
+
+    const Graph& g;
+    size_t memoryBudget;
+    uint64_t revision = 0;  // the revision of the graph the trees were computed for
+    std::list<size_t> lru;
+    std::unordered_map<size_t, Entry> trees;
+    Stats stats;
+    mutable std::mutex mutex;
+};
+
+}  // namespace shayg
@@ -0,0 +1,413 @@
+/**
+ * @author Shay Gali
+ * @link shay.gali@msmail.ariel.ac.il
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+using std::pair;
+using std::vector;
+
+namespace shayg {
+
+/**
+ * @brief the priority queue Dijkstra's algorithm uses
+ */
+enum class QueuePolicy {
+    AUTO,          // let the algorithm choose
+    BINARY_HEAP,   // std::priority_queue with duplicate entries (lazy deletion)
+    DARY_HEAP,     // indexed 4-ary heap with decrease-key
+    PAIRING_HEAP,  // pairing heap with decrease-key
+    DIAL,          // Dial's circular bucket array (for small positive integer weights)
+    RADIX_HEAP,    // radix heap (for positive integer weights)
+};
+
+// AUTO uses Dial's buckets when the largest edge weight is at most this value (the bucket array has maxEdgeWeight + 1 buckets)
+constexpr int DIAL_MAX_EDGE_WEIGHT = 256;
+
+/*
+All the queues hold the vertices 0...capacity-1 with int keys, and have the same interface:
+    push(v, key) - insert v, or decrease its key if v is already in the queue (a larger key is ignored)
+    pop()        - remove the vertex with the smallest key and return it as a {key, vertex} pair
+    empty()      - check if the queue is empty
+the ties are broken by the vertex id, so all the queues pop the vertices in the same order.
+*/
+
+/**
+ * @brief a binary heap (std::priority_queue) that keeps a new entry for every push, and skips the stale entries on pop.
+ * the heap can grow to O(E) entries.
+ */
+class BinaryHeap {
+   public:
+    explicit BinaryHeap(size_t capacity) : keys(capacity), inQueue(capacity, false), size(0) {}
+
+    bool empty() const { return size == 0; }
+
+    void push(size_t v, int key) {
+        if (inQueue[v] && keys[v] <= key) {
+            return;
+        }
+        if (!inQueue[v]) {
+            inQueue[v] = true;
+            size++;
+        }
+        keys[v] = key;
+        pq.push({key, v});
+    }
+
+    pair<int, size_t> pop() {
+        // skip the entries that were replaced by a smaller key
+        while (!inQueue[pq.top().second] || keys[pq.top().second] != pq.top().first) {
+            pq.pop();
+        }
+        pair<int, size_t> top = pq.top();
+        pq.pop();
+        inQueue[top.second] = false;
+        size--;
+        return top;
+    }
+
+   private:
+    // min heap of {key, vertex} pairs - std::greater makes the smallest pair the top
+    std::priority_queue<pair<int, size_t>, vector<pair<int, size_t>>, std::greater<pair<int, size_t>>> pq;
+    vector<int> keys;
+    vector<bool> inQueue;
+    size_t size;
+};
+
+/**
+ * @brief an indexed d-ary min heap. a position map lets push decrease the key of a vertex in place,
+ * so the heap never holds more than one entry for a vertex (O(V) memory).
+ * @tparam D the number of children of every node (4 keeps the children of a node in one cache line)
+ */
+template <size_t D = 4>
+class IndexedDaryHeap {
+   public:
+    explicit IndexedDaryHeap(size_t capacity) : keys(capacity), positions(capacity, NOT_IN_HEAP) { heap.reserve(capacity); }
+
+    bool empty() const { return heap.empty(); }
+
+    void push(size_t v, int key) {
+        if (positions[v] == NOT_IN_HEAP) {
+            keys[v] = key;
+            positions[v] = heap.size();
+            heap.push_back(v);
+        } else if (key < keys[v]) {
+            keys[v] = key;
+        } else {
+            return;
+        }
+        siftUp(positions[v]);
+    }
+
+    pair<int, size_t> pop() {
+        size_t top = heap.front();
+        positions[top] = NOT_IN_HEAP;
+        size_t last = heap.back();
+        heap.pop_back();
+        if (!heap.empty()) {
+            heap[0] = last;
+            positions[last] = 0;
+            siftDown(0);
+        }
+        return {keys[top], top};
+    }
+
+   private:
+    static constexpr size_t NOT_IN_HEAP = SIZE_MAX;
+
+    vector<size_t> heap;       // the vertices, in heap order
+    vector<int> keys;          // keys[v] - the key of the vertex v
+    vector<size_t> positions;  // positions[v] - the index of v in the heap, or NOT_IN_HEAP
+
+    bool less(size_t a, size_t b) const { return keys[a] < keys[b] || (keys[a] == keys[b] && a < b); }
+
+    void place(size_t i, size_t v) {
+        heap[i] = v;
+        positions[v] = i;
+    }
+
+    void siftUp(size_t i) {
+        size_t v = heap[i];
+        while (i > 0) {
+            size_t parent = (i - 1) / D;
+            if (!less(v, heap[parent])) {
+                break;
+            }
+            place(i, heap[parent]);
+            i = parent;
+        }
+        place(i, v);
+    }
+
+    void siftDown(size_t i) {
+        size_t v = heap[i];
+        while (true) {
+            size_t first = i * D + 1;
+            if (first >= heap.size()) {
+                break;
+            }
+            // find the smallest child
+            size_t best = first;
+            for (size_t c = first + 1; c < first + D && c < heap.size(); c++) {
+                if (less(heap[c], heap[best])) {
+                    best = c;
+                }
+            }
+            if (!less(heap[best], v)) {
+                break;
+            }
+            place(i, heap[best]);
+            i = best;
+        }
+        place(i, v);
+    }
+};
+
+/**
+ * @brief a pairing heap with decrease-key. the nodes are stored in a vector indexed by the vertex, and pop reuses one buffer for the children
+ * of the root, so the operations don't allocate (except when that buffer grows).
+ * push and decrease-key are O(1), pop is amortized O(log V).
+ */
+class PairingHeap {
+   public:
+    explicit PairingHeap(size_t capacity) : nodes(capacity), root(NIL), size(0) {}
+
+    bool empty() const { return size == 0; }
+
+    void push(size_t v, int key) {
+        Node& node = nodes[v];
+        if (!node.inHeap) {
+            node = Node{key, NIL, NIL, NIL, true};
+            size++;
+            root = meld(root, v);
+        } else if (key < node.key) {
+            node.key = key;
+            if (v != root) {
+                cut(v);
+                root = meld(root, v);
+            }
+        }
+    }
+
+    pair<int, size_t> pop() {
+        size_t top = root;
+        nodes[top].inHeap = false;
+        size--;
+
+        // two-pass merge of the children of the root: meld the children in pairs from left to right,
+        // then meld the pairs from right to left
+        children.clear();
+        for (size_t c = nodes[top].child; c != NIL;) {
+            size_t next = nodes[c].sibling;
+            nodes[c].sibling = NIL;
+            nodes[c].prev = NIL;
+            children.push_back(c);
+            c = next;
+        }
+        size_t numPairs = 0;  // the pairs are written over the start of children
+        for (size_t i = 0; i < children.size(); i += 2) {
+            children[numPairs++] = i + 1 < children.size() ? meld(children[i], children[i + 1]) : children[i];
+        }
+        root = NIL;
+        for (size_t i = numPairs; i > 0; i--) {
+            root = meld(root, children[i - 1]);
+        }
+        return {nodes[top].key, top};
+    }
+
+   private:
+    static constexpr size_t NIL = SIZE_MAX;
+
+    struct Node {
+        int key;
+        size_t child;    // the leftmost child
+        size_t sibling;  // the next sibling
+        size_t prev;     // the previous sibling, or the parent for the leftmost child
+        bool inHeap;
+    };
+
+    vector<Node> nodes;
+    vector<size_t> children;  // reused by pop
+    size_t root;
+    size_t size;
+
+    bool less(size_t a, size_t b) const { return nodes[a].key < nodes[b].key || (nodes[a].key == nodes[b].key && a < b); }
+
+    /**
+     * @brief meld two heaps (two roots without siblings) and return the new root
+     */
+    size_t meld(size_t a, size_t b) {
+        if (a == NIL) {
+            return b;
+        }
+        if (b == NIL) {
+            return a;
+        }
+        if (less(b, a)) {
+            std::swap(a, b);
+        }
+        // b becomes the leftmost child of a
+        nodes[b].sibling = nodes[a].child;
+        if (nodes[a].child != NIL) {
+            nodes[nodes[a].child].prev = b;
+        }
+        nodes[b].prev = a;
+        nodes[a].child = b;
+        return a;
+    }
+
+    /**
+     * @brief detach the subtree of v from its parent
+     */
+    void cut(size_t v) {
+        size_t prev = nodes[v].prev;
+        if (nodes[prev].child == v) {
+            nodes[prev].child = nodes[v].sibling;
+        } else {
+            nodes[prev].sibling = nodes[v].sibling;
+        }
+        if (nodes[v].sibling != NIL) {
+            nodes[nodes[v].sibling].prev = prev;
+        }
+        nodes[v].sibling = NIL;
+        nodes[v].prev = NIL;
+    }
+};
+
+/**
+ * @brief Dial's bucket queue: a circular array of maxKeyStep + 1 buckets, bucket k % (maxKeyStep + 1) holds the vertices with key k.
+ * the queue is monotone - every pushed key must be between the last popped key and the last popped key + maxKeyStep
+ * (in Dijkstra: the weights are between 1 and maxKeyStep). push and pop are O(1) amortized, plus the sort of a bucket when it is reached.
+ */
+class DialBuckets {
+   public:
+    DialBuckets(size_t capacity, int maxKeyStep)
+        : buckets((size_t)std::max(maxKeyStep, 0) + 1), keys(capacity), inQueue(capacity, false), size(0), current(0), started(false), loaded(false), activePos(0) {}
+
+    bool empty() const { return size == 0; }
+
+    void push(size_t v, int key) {
+        if (inQueue[v] && keys[v] <= key) {
+            return;
+        }
+        if (!loaded && (!started || key < current)) {  // before the first pop, the scan starts from the smallest key
+            current = key;
+            started = true;
+        }
+        if (!inQueue[v]) {
+            inQueue[v] = true;
+            size++;
+        }
+        keys[v] = key;  // the old entry of v (if any) becomes stale
+
+        if (loaded && key == current) {  // the bucket of the current key is already sorted - insert in place
+            active.insert(std::upper_bound(active.begin() + (std::ptrdiff_t)activePos, active.end(), v), v);
+        } else {
+            buckets[(size_t)key % buckets.size()].push_back(v);
+        }
+    }
+
+    pair<int, size_t> pop() {
+        while (true) {
+            if (!loaded) {
+                // take the bucket of the current key, and sort it so the ties are broken by the vertex id
+                active.clear();
+                active.swap(buckets[(size_t)current % buckets.size()]);
+                std::sort(active.begin(), active.end());
+                activePos = 0;
+                loaded = true;
+            }
+            while (activePos < active.size()) {
+                size_t v = active[activePos++];
+                if (inQueue[v] && keys[v] == current) {  // skip the stale entries
+                    inQueue[v] = false;
+                    size--;
+                    return {current, v};
+                }
+            }
+            current++;
+            loaded = false;
+        }
+    }
+
+   private:
+    vector<vector<size_t>> buckets;
+    vector<size_t> active;  // the sorted bucket of the current key
+    vector<int> keys;
+    vector<bool> inQueue;
+    size_t size;
+    int current;  // the key of the active bucket (the last popped key)
+    bool started;
+    bool loaded;
+    size_t activePos;
+};
+
+/**
+ * @brief a radix heap: the entries are kept in 65 buckets by the highest bit that differs from the last popped entry.
+ * the queue is monotone - every pushed key must be larger than the last popped key.
+ * the (key, vertex) pair is packed into one 64 bit number, so the ties are broken by the vertex id (the vertices must fit in 32 bits).
+ */
+class RadixHeap {
+   public:
+    explicit RadixHeap(size_t capacity) : keys(capacity), inQueue(capacity, false), size(0), last(0) {}
+
+    bool empty() const { return size == 0; }
+
+    void push(size_t v, int key) {
+        if (inQueue[v] && keys[v] <= key) {
+            return;
+        }
+        if (!inQueue[v]) {
+            inQueue[v] = true;
+            size++;
+        }
+        keys[v] = key;  // the old entry of v (if any) becomes stale
+        uint64_t entry = ((uint64_t)(uint32_t)key << 32) | v;
+        buckets[bucketOf(entry)].push_back(entry);
+    }
+
+    pair<int, size_t> pop() {
+        while (true) {
+            if (buckets[0].empty()) {
+                // find the first non empty bucket, and redistribute it around its minimum
+                size_t i = 1;
+                while (buckets[i].empty()) {
+                    i++;
+                }
+                last = *std::min_element(buckets[i].begin(), buckets[i].end());
+                for (uint64_t entry : buckets[i]) {
+                    buckets[bucketOf(entry)].push_back(entry);
+                }
+                buckets[i].clear();
+            }
+
+            uint64_t entry = buckets[0].back();
+            buckets[0].pop_back();
+            size_t v = (size_t)(entry & UINT32_MAX);
+            int key = (int)(entry >> 32);
+            if (inQueue[v] && keys[v] == key) {  // skip the stale entries
+                inQueue[v] = false;
+                size--;
+                return {key, v};
+            }
+        }
+    }
+
+   private:
+    vector<uint64_t> buckets[65];
+    vector<int> keys;
+    vector<bool> inQueue;
+    size_t size;
+    uint64_t last;  // the last popped entry
+
+    size_t bucketOf(uint64_t entry) const { return entry == last ? 0 : (size_t)(64 - __builtin_clzll(entry ^ last)); }
+};
+
+}  // namespace shayg
@@ -0,0 +1,106 @@
+/**
+ * @author Shay Gali
+ * @link shay.gali@msmail.ariel.ac.il
+ */
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "../graph/Graph.hpp"
+
+using std::pair;
+using std::vector;
+
+namespace shayg {
+
+/*
+The heuristics for Algorithms::aStar. a heuristic is a callable h(v, dest) that returns a lower bound of the distance from v to dest
+(it must never be larger than the real distance, otherwise A* may return a path that is not the shortest).
+the vertices are the original ids of the graph.
+*/
+
+/**
+ * @brief no heuristic - A* with it is Dijkstra's algorithm
+ */
+struct NoHeuristic {
+    int operator()(size_t /*v*/, size_t /*dest*/) const { return 0; }
+};
+
+/**
+ * @brief the straight line distance between the coordinates of the vertices.
+ * admissible when the weight of every edge is at least `scale` times the distance between its vertices.
+ */
+class EuclideanHeuristic {
+   public:
+    explicit EuclideanHeuristic(vector<pair<double, double>> coordinates, double scale = 1.0) : coordinates(std::move(coordinates)), scale(scale) {}
+
+    int operator()(size_t v, size_t dest) const {
+        double dx = coordinates[v].first - coordinates[dest].first;
+        double dy = coordinates[v].second - coordinates[dest].second;
+        return (int)std::floor(scale * std::sqrt(dx * dx + dy * dy));
+    }
+
+   private:
+    vector<pair<double, double>> coordinates;
+    double scale;
+};
+
+/**
+ * @brief the grid (L1) distance between the coordinates of the vertices.
+ * admissible when the edges only move along the axes and the weight of every edge is at least `scale` times its length.
+ */
+class ManhattanHeuristic {
+   public:
+    explicit ManhattanHeuristic(vector<pair<double, double>> coordinates, double scale = 1.0) : coordinates(std::move(coordinates)), scale(scale) {}
+
+    int operator()(size_t v, size_t dest) const {
+        double dx = std::abs(coordinates[v].first - coordinates[dest].first);
+        double dy = std::abs(coordinates[v].second - coordinates[dest].second);
+        return (int)std::floor(scale * (dx + dy));
+    }
+
+   private:
+    vector<pair<double, double>> coordinates;
+    double scale;
+};
+
+/**
+ * @brief ALT (A*, landmarks, triangle inequality): for every landmark L we know d(L, v) and d(v, L) for all the vertices, so
+ * d(v, dest) >= d(L, dest) - d(L, v) and d(v, dest) >= d(v, L) - d(dest, L). the bound is the largest of them over all the landmarks.
+ */
+class AltHeuristic {
+   public:
+    /**
+     * @param fromLandmarks fromLandmarks[i][v] - the distance from the i-th landmark to v (INF if there is no path)
+     * @param toLandmarks toLandmarks[i][v] - the distance from v to the i-th landmark (INF if there is no path)
+     */
+    AltHeuristic(vector<vector<int>> fromLandmarks, vector<vector<int>> toLandmarks)
+        : fromLandmarks(std::move(fromLandmarks)), toLandmarks(std::move(toLandmarks)) {}
+
+    int operator()(size_t v, size_t dest) const {
+        int bound = 0;
+        for (const vector<int>& from : fromLandmarks) {
+            if (from[dest] != INF && from[v] != INF) {
+                bound = std::max(bound, from[dest] - from[v]);
+            }
+        }
+        for (const vector<int>& to : toLandmarks) {
+            if (to[v] != INF && to[dest] != INF) {
+                bound = std::max(bound, to[v] - to[dest]);
+            }
+        }
+        return bound;
+    }
+
+    const vector<vector<int>>& getFromLandmarks() const { return fromLandmarks; }
+    const vector<vector<int>>& getToLandmarks() const { return toLandmarks; }
+
+   private:
+    vector<vector<int>> fromLandmarks;
+    vector<vector<int>> toLandmarks;
+};
+
+}  // namespace shayg
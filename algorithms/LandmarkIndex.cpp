@@ -0,0 +1,295 @@
+/**
+ * @author Shay Gali
+ * @link shay.gali@msmail.ariel.ac.il
+ */
+#include "LandmarkIndex.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include "Heaps.hpp"
+
+using namespace shayg;
+
+using std::invalid_argument;
+using std::pair;
+using std::runtime_error;
+
+constexpr char INDEX_MAGIC[] = {'S', 'G', 'L'};
+constexpr uint8_t INDEX_VERSION = 1;
+
+// ~~~ declare the helper functions ~~~
+
+pair<vector<int>, vector<int>> landmarkDistances(const Graph& g, size_t src, bool backward);
+size_t farthestVertex(const vector<int>& distances, const vector<bool>& isLandmark);
+size_t avoidVertex(const Graph& g, size_t root, const AltHeuristic& bounds, const vector<bool>& isLandmark);
+uint64_t mix(uint64_t value);
+
+void writeFixed(std::ostream& os, uint64_t value, size_t bytes);
+uint64_t readFixed(std::istream& is, size_t bytes);
+
+// ~~~ implement the functions ~~~
+
+LandmarkIndex::LandmarkIndex(const Graph& g, size_t numLandmarks, Selection selection)
+    : heuristic({}, {}), revision(g.getRevision()), graphFingerprint(fingerprint(g)) {
+    if (g.isHaveNegativeEdgeWeight()) {
+        throw invalid_argument("The landmark bounds need non-negative weights.");
+    }
+
+    size_t n = g.getNumVertices();
+    numLandmarks = std::min(numLandmarks, n);
+
+    vector<vector<int>> fromLandmarks;
+    vector<vector<int>> toLandmarks;
+    vector<bool> isLandmark(n, false);
+    vector<int> closest(n, INF);  // closest[v] - the distance from the nearest landmark to v
+
+    for (size_t k = 0; k < numLandmarks; k++) {
+        size_t next;
+        if (k == 0) {  // start from the vertex farthest from vertex 0
+            next = farthestVertex(landmarkDistances(g, 0, false).first, isLandmark);
+        } else if (selection == Selection::FARTHEST) {
+            next = farthestVertex(closest, isLandmark);
+        } else {
+            next = avoidVertex(g, farthestVertex(closest, isLandmark), AltHeuristic(fromLandmarks, toLandmarks), isLandmark);
+        }
+
+        isLandmark[next] = true;
+        landmarks.push_back(next);
+        fromLandmarks.push_back(landmarkDistances(g, next, false).first);
+        // in an undirected graph the distances to the landmark are the same as the distances from it
+        toLandmarks.push_back(g.isDirectedGraph() ? landmarkDistances(g, next, true).first : fromLandmarks.back());
+        for (size_t v = 0; v < n; v++) {
+            closest[v] = std::min(closest[v], fromLandmarks.back()[v]);
+        }
+    }
+
+    heuristic = AltHeuristic(std::move(fromLandmarks), std::move(toLandmarks));
+}
+
+Algorithms::ShortestPathResult LandmarkIndex::query(const Graph& g, size_t src, size_t dest) const {
+    if (!isValidFor(g)) {
+        throw std::logic_error("The landmark index is out of date, the graph was changed after the index was built.");
+    }
+    return Algorithms::aStar(g, src, dest, heuristic);
+}
+
+void LandmarkIndex::save(std::ostream& os) const {
+    size_t n = heuristic.getFromLandmarks().empty() ? 0 : heuristic.getFromLandmarks()[0].size();
+
+    os.write(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    os.put((char)INDEX_VERSION);
+    writeFixed(os, n, 8);
+    writeFixed(os, landmarks.size(), 8);
+    writeFixed(os, graphFingerprint, 8);
+    for (size_t i = 0; i < landmarks.size(); i++) {
+        writeFixed(os, landmarks[i], 8);
+        for (const vector<int>* table : {&heuristic.getFromLandmarks()[i], &heuristic.getToLandmarks()[i]}) {
+            for (int distance : *table) {
+                writeFixed(os, (uint32_t)distance, 4);
+            }
+        }
+    }
+    if (!os) {
+        throw runtime_error("Failed to write the landmark index.");
+    }
+}
+
+LandmarkIndex LandmarkIndex::load(std::istream& is, const Graph& g) {
+    char magic[sizeof(INDEX_MAGIC)];
+    is.read(magic, sizeof(magic));
+    if (!is || !std::equal(magic, magic + sizeof(magic), INDEX_MAGIC) || is.get() != INDEX_VERSION) {
+        throw runtime_error("Not a landmark index.");
+    }
+
+    size_t n = readFixed(is, 8);
+    size_t numLandmarks = readFixed(is, 8);
+    uint64_t savedFingerprint = readFixed(is, 8);
+    if (n != g.getNumVertices() || savedFingerprint != fingerprint(g)) {
+        throw runtime_error("The landmark index was built from a different graph.");
+    }
+    if (numLandmarks > n) {
+        throw runtime_error("The landmark index is corrupted.");
+    }
+
+    vector<size_t> landmarks(numLandmarks);
+    vector<vector<int>> fromLandmarks(numLandmarks, vector<int>(n));
+    vector<vector<int>> toLandmarks(numLandmarks, vector<int>(n));
+    for (size_t i = 0; i < numLandmarks; i++) {
+        landmarks[i] = readFixed(is, 8);
+        if (landmarks[i] >= n) {
+            throw runtime_error("The landmark index is corrupted.");
+        }
+        for (vector<int>* table : {&fromLandmarks[i], &toLandmarks[i]}) {
+            for (int& distance : *table) {
+                distance = (int)(uint32_t)readFixed(is, 4);
+            }
+        }
+    }
+
+    return LandmarkIndex(std::move(landmarks), AltHeuristic(std::move(fromLandmarks), std::move(toLandmarks)), g.getRevision(),
+                         savedFingerprint);
+}
+
+uint64_t LandmarkIndex::fingerprint(const Graph& g) {
+    // the hashes of the edges are added, so the result does not depend on the order of the vertices (reorder)
+    uint64_t hash = mix(g.getNumVertices()) ^ (g.isDirectedGraph() ? 1 : 0);
+    for (size_t u = 0; u < g.getNumVertices(); u++) {
+        for (auto [v, w] : g.neighbors(u)) {
+            hash += mix(mix(g.toOriginalId(u)) ^ (g.toOriginalId(v) << 1) ^ ((uint64_t)(uint32_t)w << 40));
+        }
+    }
+    return hash;
+}
+
+// ~~~ implement the helper functions ~~~
+
+/**
+ * @brief Dijkstra's algorithm from src over the out-edges, or over the in-edges if backward is true
+ * (then the distances are the distances from every vertex to src).
+ * @param g the graph (with non-negative weights)
+ * @param src the source vertex (original id)
+ * @return the distances and the parents, both by the original ids (INF / -1 for the vertices that are not reachable)
+ */
+pair<vector<int>, vector<int>> landmarkDistances(const Graph& g, size_t src, bool backward) {
+    size_t n = g.getNumVertices();
+    vector<int> distances(n, INF);
+    vector<int> parents(n, -1);
+    IndexedDaryHeap<4> pq(n);
+
+    size_t from = g.toInternalId(src);
+    distances[from] = 0;
+    pq.push(from, 0);
+    while (!pq.empty()) {
+        size_t u = pq.pop().second;
+        for (auto [v, w] : backward ? g.inNeighbors(u) : g.neighbors(u)) {
+            int currDist = distances[u] + w;
+            if (currDist < distances[v]) {
+                distances[v] = currDist;
+                parents[v] = (int)u;
+                pq.push(v, currDist);
+            }
+        }
+    }
+
+    if (!g.isReordered()) {
+        return {distances, parents};
+    }
+    vector<int> originalDistances(n);
+    vector<int> originalParents(n);
+    for (size_t v = 0; v < n; v++) {
+        originalDistances[g.toOriginalId(v)] = distances[v];
+        originalParents[g.toOriginalId(v)] = parents[v] == -1 ? -1 : (int)g.toOriginalId((size_t)parents[v]);
+    }
+    return {originalDistances, originalParents};
+}
+
+/**
+ * @brief the vertex with the largest distance that is not a landmark (a vertex that is not reachable is the farthest)
+ */
+size_t farthestVertex(const vector<int>& distances, const vector<bool>& isLandmark) {
+    size_t best = 0;
+    bool found = false;
+    for (size_t v = 0; v < distances.size(); v++) {
+        if (!isLandmark[v] && (!found || distances[v] > distances[best])) {
+            best = v;
+            found = true;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief the "avoid" selection: build a shortest path tree from root, and give every vertex the weight d(root, v) - bound(root, v)
+ * (how much the current landmarks underestimate the distance). the size of a vertex is the total weight of its subtree,
+ * or 0 if the subtree already has a landmark. the new landmark is the leaf we get to by always going down to the largest child.
+ * @return the new landmark (original id)
+ */
+size_t avoidVertex(const Graph& g, size_t root, const AltHeuristic& bounds, const vector<bool>& isLandmark) {
+    size_t n = g.getNumVertices();
+    auto [distances, parents] = landmarkDistances(g, root, false);
+
+    // the children of a vertex have larger distances (the weights are positive), so go over the vertices from the farthest
+    vector<size_t> order;
+    for (size_t v = 0; v < n; v++) {
+        if (distances[v] != INF) {
+            order.push_back(v);
+        }
+    }
+    std::sort(order.begin(), order.end(), [&distances](size_t a, size_t b) { return distances[a] > distances[b]; });
+
+    vector<long long> sizes(n, 0);
+    vector<bool> hasLandmark(n, false);
+    for (size_t v : order) {
+        hasLandmark[v] = hasLandmark[v] || isLandmark[v];
+        if (hasLandmark[v]) {
+            sizes[v] = 0;
+        } else {
+            sizes[v] += distances[v] - bounds(root, v);
+        }
+        if (parents[v] != -1) {
+            size_t parent = (size_t)parents[v];
+            hasLandmark[parent] = hasLandmark[parent] || hasLandmark[v];
+            sizes[parent] += sizes[v];
+        }
+    }
+
+    vector<vector<size_t>> children(n);
+    for (size_t v : order) {
+        if (parents[v] != -1) {
+            children[(size_t)parents[v]].push_back(v);
+        }
+    }
+
+    // go down to the largest child, until we get to a leaf
+    size_t v = root;
+    while (true) {
+        size_t next = v;
+        for (size_t c : children[v]) {
+            if (sizes[c] > 0 && (next == v || sizes[c] > sizes[next])) {
+                next = c;
+            }
+        }
+        if (next == v) {
+            break;
+        }
+        v = next;
+    }
+    return isLandmark[v] ? farthestVertex(distances, isLandmark) : v;
+}
+
+/**
+ * @brief splitmix64 finalizer - spread the bits of a number
+ */
+uint64_t mix(uint64_t value) {
+    value += 0x9e3779b97f4a7c15ULL;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
+
+/**
+ * @brief write a number with a fixed number of bytes, little endian
+ */
+void writeFixed(std::ostream& os, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; i++) {
+        os.put((char)(uint8_t)(value >> (8 * i)));
+    }
+}
+
+/**
+ * @brief read a number that was written with writeFixed
+ * @throw runtime_error if the stream ended
+ */
+uint64_t readFixed(std::istream& is, size_t bytes) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; i++) {
+        int byte = is.get();
+        if (byte == EOF) {
+            throw runtime_error("Unexpected end of the landmark index.");
+        }
+        value |= (uint64_t)(uint8_t)byte << (8 * i);
+    }
+    return value;
+}
@@ -0,0 +1,103 @@
+/**
+ * @author Shay Gali
+ * @link shay.gali@msmail.ariel.ac.il
+ */
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "../graph/Graph.hpp"
+#include "Algorithms.hpp"
+#include "Heuristics.hpp"
+
+using std::vector;
+
+namespace shayg {
+
+/**
+ * @brief Preprocessing for repeated shortest path queries on the same graph (ALT).
+ *
+ * The index selects k landmarks and stores the distances from every landmark to all the vertices and from all the vertices
+ * to every landmark. A query runs A* with the triangle inequality lower bounds of these tables (AltHeuristic).
+ *
+ * The index belongs to the graph it was built from: when the graph changes (Graph::getRevision), the index is out of date
+ * and must be built again. The tables can be saved to a file next to the graph, and loaded back for the same graph.
+ */
+class LandmarkIndex {
+   public:
+    /**
+     * @brief how to select the landmarks
+     */
+    enum class Selection {
+        FARTHEST,  // every new landmark is the vertex farthest from the landmarks selected so far
+        AVOID      // every new landmark is a leaf of a shortest path tree, in the subtree where the current bounds are the worst
+    };
+
+    /**
+     * @brief Select the landmarks and compute the distance tables
+     * @param g the graph (the weights must be non-negative)
+     * @param numLandmarks the number of landmarks (at most |V|)
+     * @param selection how to select the landmarks
+     * @throw invalid_argument if the graph has negative weights
+     */
+    LandmarkIndex(const Graph& g, size_t numLandmarks, Selection selection = Selection::FARTHEST);
+
+    /**
+     * @brief get the landmarks (original ids)
+     */
+    const vector<size_t>& getLandmarks() const { return landmarks; }
+
+    /**
+     * @brief get the heuristic of the index, can be passed to Algorithms::aStar
+     */
+    const AltHeuristic& getHeuristic() const { return heuristic; }
+
+    /**
+     * @brief check if the index was built from this graph, and the graph did not change since
+     */
+    bool isValidFor(const Graph& g) const { return g.getRevision() == revision; }
+
+    /**
+     * @brief Find the shortest path between two vertices with A* and the landmark bounds
+     * @param g the graph the index was built from
+     * @param src the source vertex
+     * @param dest the destination vertex
+     * @return ShortestPathResult the status of the query, the distance and the vertices of the path
+     * @throw logic_error if the index is out of date (the graph changed after the index was built)
+     * @throw invalid_argument if the source or destination vertices are not in the graph
+     */
+    Algorithms::ShortestPathResult query(const Graph& g, size_t src, size_t dest) const;
+
+    /**
+     * @brief Write the landmarks and the distance tables to the output stream
+     * @param os the output stream (should be opened in binary mode)
+     */
+    void save(std::ostream& os) const;
+
+    /**
+     * @brief Read an index that was written with save()
+     * @param is the input stream
+     * @param g the graph the index was built from
+     * @return LandmarkIndex the index, valid for g
+     * @throw runtime_error if the data is not a valid index, or it was built from a different graph
+     */
+    static LandmarkIndex load(std::istream& is, const Graph& g);
+
+    /**
+     * @brief a hash of the edges of the graph (with the original ids), saved with the index to check that it is loaded for the same graph
+     */
+    static uint64_t fingerprint(const Graph& g);
+
+   private:
+    LandmarkIndex(vector<size_t> landmarks, AltHeuristic heuristic, uint64_t revision, uint64_t graphFingerprint)
+        : landmarks(std::move(landmarks)), heuristic(std::move(heuristic)), revision(revision), graphFingerprint(graphFingerprint) {}
+
+    vector<size_t> landmarks;
+    AltHeuristic heuristic;
+    uint64_t revision;          // the revision of the graph the index was built from
+    uint64_t graphFingerprint;  // the fingerprint of the graph the index was built from
+};
+
+}  // namespace shayg
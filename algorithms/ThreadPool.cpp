@@ -0,0 +1,129 @@
+/**
+ * @author Shay Gali
+ * @link shay.gali@msmail.ariel.ac.il
+ */
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+using namespace shayg;
+
+// the pool whose task the thread is running now (nullptr outside of a task), to detect a run from inside a task
+thread_local const ThreadPool* runningPool = nullptr;
+
+ThreadPool::ThreadPool(size_t numThreads) {
+    numThreads = std::max<size_t>(numThreads, 1);
+    for (size_t i = 1; i < numThreads; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::run(size_t numTasks, const std::function<void(size_t)>& task) {
+    if (numTasks == 0) {
+        return;
+    }
+
+    // a task of this pool that runs a job on it: the other threads may be waiting for this task, so the job runs here
+    if (runningPool == this) {
+        std::exception_ptr firstError;
+        for (size_t i = 0; i < numTasks; i++) {
+            try {
+                task(i);
+            } catch (...) {
+                if (!firstError) {
+                    firstError = std::current_exception();
+                }
+            }
+        }
+        if (firstError) {
+            std::rethrow_exception(firstError);
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> runLock(runMutex);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &task;
+        jobSize = numTasks;
+        finished = 0;
+        error = nullptr;
+        nextTask = 0;  // last: a worker that takes a task sees the job
+        generation++;
+    }
+    wakeUp.notify_all();
+
+    work();  // the calling thread takes tasks too
+
+    // also wait for the workers to leave the job, so none of them takes a task of the next job with an index of this one
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return finished == jobSize && busyWorkers == 0; });
+    job = nullptr;
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::workerLoop() {
+    uint64_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeUp.wait(lock, [this, seen] { return stopping || generation != seen; });
+            if (stopping) {
+                return;
+            }
+            seen = generation;
+            busyWorkers++;
+        }
+        work();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--busyWorkers == 0) {
+                done.notify_all();
+            }
+        }
+    }
+}
+
+void ThreadPool::work() {
+    while (true) {
+        size_t i = nextTask.fetch_add(1);
+        if (i >= jobSize) {
+            return;
+        }
+
+        const ThreadPool* outerPool = runningPool;  // a task of another pool may be running this one
+        runningPool = this;
+        try {
+            (*job)(i);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+        runningPool = outerPool;
+
+        if (finished.fetch_add(1) + 1 == jobSize) {
+            std::lock_guard<std::mutex> lock(mutex);
+            done.notify_all();
+        }
+    }
+}
@@ -0,0 +1,79 @@
+/**
+ * @author Shay Gali
+ * @link shay.gali@msmail.ariel.ac.il
+ */
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using std::vector;
+
+namespace shayg {
+
+/**
+ * @brief how an algorithm runs: on the calling thread, or on the threads of ThreadPool::shared()
+ */
+enum class ExecutionPolicy {
+    SEQUENTIAL,
+    PARALLEL
+};
+
+/**
+ * @brief a fixed set of worker threads that run the tasks of one job at a time.
+ * run(numTasks, task) calls task(0), ..., task(numTasks - 1) on the workers (and the calling thread), and returns when all of them are done.
+ * the threads are created once, so a job costs a wake up and not a thread creation (the algorithms run a job for every round).
+ * a task can call run on its own pool (a parallel algorithm inside a parallel algorithm): the nested job runs on the thread of the task.
+ */
+class ThreadPool {
+   public:
+    /**
+     * @param numThreads the number of threads that run the tasks, including the thread that calls run (at least 1)
+     */
+    explicit ThreadPool(size_t numThreads = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t getNumThreads() const { return workers.size() + 1; }
+
+    /**
+     * @brief run task(i) for every i in [0, numTasks), and wait for all the tasks.
+     * called from a task of this pool, the tasks run one after the other on the calling thread.
+     * @throw the first exception a task threw (after all the tasks are done)
+     */
+    void run(size_t numTasks, const std::function<void(size_t)>& task);
+
+    /**
+     * @brief the pool the parallel algorithms use, with a thread for every core
+     */
+    static ThreadPool& shared();
+
+   private:
+    void workerLoop();
+    void work();  // take tasks of the current job until there are no more
+
+    vector<std::thread> workers;
+    std::mutex runMutex;  // one job at a time
+    std::mutex mutex;
+    std::condition_variable wakeUp;  // a new job, or the pool is stopping
+    std::condition_variable done;    // all the tasks of the job are done
+    bool stopping = false;
+    uint64_t generation = 0;  // the number of jobs so far, a worker waits for a new one
+    size_t busyWorkers = 0;   // the workers that are taking tasks of the current job
+
+    std::atomic<const std::function<void(size_t)>*> job{nullptr};
+    std::atomic<size_t> jobSize{0};
+    std::atomic<size_t> nextTask{0};
+    std::atomic<size_t> finished{0};
+    std::exception_ptr error;
+};
+
+}  // namespace shayg
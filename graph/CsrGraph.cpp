@@ -0,0 +1,417 @@
+/**
+ * @author Shay Gali
+ * @link shay.gali@msmail.ariel.ac.il
+ */
+#include "CsrGraph.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <queue>
+#include <stdexcept>
+
+using namespace shayg;
+
+using std::invalid_argument;
+using std::runtime_error;
+
+constexpr char CSR_MAGIC[] = {'S', 'G', 'C', 'R'};
+constexpr uint32_t CSR_VERSION = 1;
+
+// graph flags
+constexpr uint32_t FLAG_DIRECTED = 1;
+constexpr uint32_t FLAG_WEIGHTED = 2;
+constexpr uint32_t FLAG_NEGATIVE = 4;
+
+constexpr size_t IO_BUFFER_EDGES = 4096;
+
+/**
+ * @brief the header in the start of a CSR file
+ */
+struct CsrFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t numVertices;
+    uint64_t numEdges;
+    uint32_t flags;
+    uint32_t reserved;
+};
+static_assert(sizeof(CsrFileHeader) == 32, "the CSR header must be 32 bytes");
+
+/**
+ * @brief write to a file at increasing positions through a buffer (two writers can fill two regions of the same file)
+ */
+class RegionWriter {
+   public:
+    RegionWriter(int fd, size_t position) : fd(fd), position(position) { buffer.reserve(IO_BUFFER_EDGES * sizeof(uint32_t)); }
+
+    template <typename T>
+    void write(const T& value) {
+        const char* bytes = reinterpret_cast<const char*>(&value);
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+        if (buffer.size() >= IO_BUFFER_EDGES * sizeof(uint32_t)) {
+            flush();
+        }
+    }
+
+    void flush() {
+        size_t written = 0;
+        while (written < buffer.size()) {
+            ssize_t res = pwrite(fd, buffer.data() + written, buffer.size() - written, static_cast<off_t>(position + written));
+            if (res < 0) {
+                throw runtime_error("Failed to write the CSR file.");
+            }
+            written += static_cast<size_t>(res);
+        }
+        position += buffer.size();
+        buffer.clear();
+    }
+
+   private:
+    int fd;
+    size_t position;
+    vector<char> buffer;
+};
+
+/**
+ * @brief read the edges of a sorted run file through a buffer
+ */
+class RunReader {
+   public:
+    explicit RunReader(const string& path) : in(path, std::ios::binary), buffer(IO_BUFFER_EDGES), pos(0), count(0) {
+        if (!in) {
+            throw runtime_error("Failed to open the run file " + path + ".");
+        }
+    }
+
+    /**
+     * @brief read the next edge of the run
+     * @return false if the run is over
+     */
+    bool next(CsrEdge& edge) {
+        if (pos == count) {
+            in.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(buffer.size() * sizeof(CsrEdge)));
+            count = static_cast<size_t>(in.gcount()) / sizeof(CsrEdge);
+            pos = 0;
+            if (count == 0) {
+                return false;
+            }
+        }
+        edge = buffer[pos++];
+        return true;
+    }
+
+   private:
+    std::ifstream in;
+    vector<CsrEdge> buffer;
+    size_t pos;
+    size_t count;
+};
+
+// ~~~ declare the helper functions ~~~
+
+bool edgeLess(const CsrEdge& a, const CsrEdge& b);
+void writeCsrFile(const string& path, size_t numVertices, size_t numEdges, uint32_t flags, const std::function<bool(CsrEdge&)>& nextEdge);
+
+// ~~~ implement the functions ~~~
+
+// ~ CsrBuilder ~
+
+CsrBuilder::CsrBuilder(string path, size_t numVertices, bool isDirected, size_t maxEdgesInMemory)
+    : path(std::move(path)),
+      numVertices(numVertices),
+      isDirected(isDirected),
+      isWeighted(false),
+      haveNegativeEdgeWeight(false),
+      maxEdgesInMemory(maxEdgesInMemory),
+      numEdges(0),
+      finished(false) {
+    if (numVertices > std::numeric_limits<uint32_t>::max()) {
+        throw invalid_argument("The CSR format supports up to 2^32 - 1 vertices.");
+    }
+    if (maxEdgesInMemory == 0) {
+        throw invalid_argument("maxEdgesInMemory must be positive.");
+    }
+}
+
+CsrBuilder::~CsrBuilder() {
+    for (const string& runPath : runPaths) {
+        std::remove(runPath.c_str());
+    }
+}
+
+void CsrBuilder::addEdge(size_t u, size_t v, int weight) {
+    if (finished) {
+        throw std::logic_error("The CSR file was already built.");
+    }
+    if (u >= numVertices || v >= numVertices) {
+        throw invalid_argument("Invalid edge (" + std::to_string(u) + ", " + std::to_string(v) + "): the vertex is not in the graph.");
+    }
+    if (u == v) {
+        throw invalid_argument("Invalid edge (" + std::to_string(u) + ", " + std::to_string(v) + "): self loops are not allowed.");
+    }
+    if (weight == NO_EDGE) {
+        throw invalid_argument("The weight of an edge can not be NO_EDGE.");
+    }
+
+    if (weight != 1) {
+        isWeighted = true;
+    }
+    if (weight < 0) {
+        haveNegativeEdgeWeight = true;
+    }
+
+    push(static_cast<uint32_t>(u), static_cast<uint32_t>(v), weight);
+    if (!isDirected) {
+        push(static_cast<uint32_t>(v), static_cast<uint32_t>(u), weight);
+    }
+}
+
+void CsrBuilder::push(uint32_t from, uint32_t to, int32_t weight) {
+    buffer.push_back({from, to, weight});
+    numEdges++;
+    if (buffer.size() >= maxEdgesInMemory) {
+        spill();
+    }
+}
+
+void CsrBuilder::spill() {
+    std::sort(buffer.begin(), buffer.end(), edgeLess);
+
+    string runPath = path + ".run" + std::to_string(runPaths.size());
+    std::ofstream out(runPath, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size() * sizeof(CsrEdge)));
+    if (!out) {
+        std::remove(runPath.c_str());
+        throw runtime_error("Failed to write the run file " + runPath + ".");
+    }
+    runPaths.push_back(runPath);
+
+    buffer.clear();
+    buffer.shrink_to_fit();
+}
+
+void CsrBuilder::finish() {
+    if (finished) {
+        throw std::logic_error("The CSR file was already built.");
+    }
+    finished = true;
+
+    uint32_t flags = 0;
+    if (isDirected) {
+        flags |= FLAG_DIRECTED;
+    }
+    if (isWeighted) {
+        flags |= FLAG_WEIGHTED;
+    }
+    if (haveNegativeEdgeWeight) {
+        flags |= FLAG_NEGATIVE;
+    }
+
+    // all the edges fit in the memory - no need to merge
+    if (runPaths.empty()) {
+        std::sort(buffer.begin(), buffer.end(), edgeLess);
+        size_t i = 0;
+        writeCsrFile(path, numVertices, numEdges, flags, [this, &i](CsrEdge& edge) {
+            if (i == buffer.size()) {
+                return false;
+            }
+            edge = buffer[i++];
+            return true;
+        });
+        buffer.clear();
+        return;
+    }
+
+    if (!buffer.empty()) {
+        spill();
+    }
+
+    // k-way merge of the sorted runs, with a min heap of the current edge of every run
+    vector<RunReader> readers;
+    readers.reserve(runPaths.size());
+    for (const string& runPath : runPaths) {
+        readers.emplace_back(runPath);
+    }
+
+    auto greater = [](const pair<CsrEdge, size_t>& a, const pair<CsrEdge, size_t>& b) { return edgeLess(b.first, a.first); };
+    std::priority_queue<pair<CsrEdge, size_t>, vector<pair<CsrEdge, size_t>>, decltype(greater)> heap(greater);
+    for (size_t r = 0; r < readers.size(); r++) {
+        CsrEdge edge{};
+        if (readers[r].next(edge)) {
+            heap.push({edge, r});
+        }
+    }
+
+    writeCsrFile(path, numVertices, numEdges, flags, [&readers, &heap](CsrEdge& edge) {
+        if (heap.empty()) {
+            return false;
+        }
+        size_t r = heap.top().second;
+        edge = heap.top().first;
+        heap.pop();
+
+        CsrEdge nextEdge{};
+        if (readers[r].next(nextEdge)) {
+            heap.push({nextEdge, r});
+        }
+        return true;
+    });
+
+    readers.clear();
+    for (const string& runPath : runPaths) {
+        std::remove(runPath.c_str());
+    }
+    runPaths.clear();
+}
+
+// ~ MappedCsrGraph ~
+
+MappedCsrGraph::MappedCsrGraph(const string& path) : data(nullptr), size(0) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw runtime_error("Failed to open the CSR file " + path + ".");
+    }
+
+    struct stat st {};
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(CsrFileHeader)) {
+        close(fd);
+        throw runtime_error("Invalid CSR file " + path + ".");
+    }
+    size = static_cast<size_t>(st.st_size);
+
+    data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // the mapping stays valid after closing the file
+    if (data == MAP_FAILED) {
+        data = nullptr;
+        throw runtime_error("Failed to map the CSR file " + path + ".");
+    }
+
+    CsrFileHeader header{};
+    std::memcpy(&header, data, sizeof(header));
+    numVertices = header.numVertices;
+    numEdges = header.numEdges;
+
+    // the counts come from the file: bound them by the size of the file before multiplying, so the expected size can't wrap around
+    size_t bodySize = size - sizeof(CsrFileHeader);
+    size_t edgeSize = sizeof(uint32_t) + sizeof(int32_t);
+    bool validCounts = numVertices < bodySize / sizeof(uint64_t) && numEdges <= bodySize / edgeSize;
+    if (std::memcmp(header.magic, CSR_MAGIC, sizeof(CSR_MAGIC)) != 0 || header.version != CSR_VERSION || !validCounts ||
+        bodySize != (numVertices + 1) * sizeof(uint64_t) + numEdges * edgeSize) {
+        munmap(data, size);
+        throw runtime_error("Invalid CSR file " + path + ".");
+    }
+
+    isDirected = (header.flags & FLAG_DIRECTED) != 0;
+    isWeighted = (header.flags & FLAG_WEIGHTED) != 0;
+    haveNegativeEdgeWeight = (header.flags & FLAG_NEGATIVE) != 0;
+
+    const char* bytes = static_cast<const char*>(data);
+    offsets = reinterpret_cast<const uint64_t*>(bytes + sizeof(CsrFileHeader));
+    targets = reinterpret_cast<const uint32_t*>(offsets + numVertices + 1);
+    weights = reinterpret_cast<const int32_t*>(targets + numEdges);
+
+    // the offsets must be sorted and end at |E|, so neighbors() never reads out of the file
+    bool validOffsets = offsets[0] == 0 && offsets[numVertices] == numEdges;
+    for (size_t u = 0; u < numVertices && validOffsets; u++) {
+        validOffsets = offsets[u] <= offsets[u + 1];
+    }
+    if (!validOffsets) {
+        munmap(data, size);
+        throw runtime_error("Invalid CSR file " + path + ": corrupted offsets.");
+    }
+
+    // and every target must be a vertex, so the algorithms can index their arrays with it
+    for (size_t i = 0; i < numEdges; i++) {
+        if (targets[i] >= numVertices) {
+            munmap(data, size);
+            throw runtime_error("Invalid CSR file " + path + ": corrupted targets.");
+        }
+    }
+}
+
+MappedCsrGraph::~MappedCsrGraph() {
+    if (data != nullptr) {
+        munmap(data, size);
+    }
+}
+
+// ~~~ implement the helper functions ~~~
+
+/**
+ * @brief order the edges by source and then by target (the CSR order)
+ */
+bool edgeLess(const CsrEdge& a, const CsrEdge& b) {
+    return a.from != b.from ? a.from < b.from : a.to < b.to;
+}
+
+/**
+ * @brief Write a CSR file from a sorted stream of edges
+ * @param path the path of the file
+ * @param numVertices |V|
+ * @param numEdges |E|, the number of edges nextEdge will return
+ * @param flags the graph flags
+ * @param nextEdge put the next edge in its argument and return true, or return false when there are no more edges
+ * @throw invalid_argument if the same edge appears twice
+ */
+void writeCsrFile(const string& path, size_t numVertices, size_t numEdges, uint32_t flags, const std::function<bool(CsrEdge&)>& nextEdge) {
+    int fd = open(path.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0644);
+    if (fd < 0) {
+        throw runtime_error("Failed to create the CSR file " + path + ".");
+    }
+
+    try {
+        // the targets and the weights are written together, to two regions of the file
+        size_t targetsPosition = sizeof(CsrFileHeader) + (numVertices + 1) * sizeof(uint64_t);
+        RegionWriter targets(fd, targetsPosition);
+        RegionWriter weights(fd, targetsPosition + numEdges * sizeof(uint32_t));
+
+        vector<uint64_t> offsets(numVertices + 1, 0);
+        CsrEdge edge{};
+        CsrEdge prev{};
+        bool first = true;
+        while (nextEdge(edge)) {
+            if (!first && prev.from == edge.from && prev.to == edge.to) {
+                throw invalid_argument("The edge (" + std::to_string(edge.from) + ", " + std::to_string(edge.to) + ") was added twice.");
+            }
+            offsets[edge.from + 1]++;
+            targets.write(edge.to);
+            weights.write(edge.weight);
+            prev = edge;
+            first = false;
+        }
+        targets.flush();
+        weights.flush();
+
+        // turn the degrees into offsets
+        for (size_t u = 0; u < numVertices; u++) {
+            offsets[u + 1] += offsets[u];
+        }
+
+        CsrFileHeader header{};
+        std::memcpy(header.magic, CSR_MAGIC, sizeof(CSR_MAGIC));
+        header.version = CSR_VERSION;
+        header.numVertices = numVertices;
+        header.numEdges = numEdges;
+        header.flags = flags;
+
+        RegionWriter start(fd, 0);
+        start.write(header);
+        for (uint64_t offset : offsets) {
+            start.write(offset);
+        }
+        start.flush();
+    } catch (...) {
+        close(fd);
+        std::remove(path.c_str());
+        throw;
+    }
+    close(fd);
+}
@@ -0,0 +1,190 @@
+/**
+ * @author Shay Gali
+ * @link shay.gali@msmail.ariel.ac.il
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Graph.hpp"
+
+using std::pair;
+using std::string;
+using std::vector;
+
+namespace shayg {
+
+/**
+ * @brief an edge as it is stored in the sorted runs of the CsrBuilder
+ */
+struct CsrEdge {
+    uint32_t from;
+    uint32_t to;
+    int32_t weight;
+};
+
+/**
+ * @brief Build an on-disk CSR (compressed sparse row) graph from a stream of edges, using bounded memory.
+ *
+ * The edges are collected in a buffer of at most maxEdgesInMemory edges. When the buffer is full,
+ * it is sorted and spilled to a run file next to the output file.
+ * finish() merges all the sorted runs into the CSR file, that can then be opened with MappedCsrGraph.
+ *
+ * The CSR file layout is:
+ * a 32 bytes header (magic, version, |V|, |E|, flags), (|V| + 1) uint64 row offsets,
+ * |E| uint32 targets and |E| int32 weights.
+ */
+class CsrBuilder {
+   public:
+    static constexpr size_t DEFAULT_MAX_EDGES_IN_MEMORY = size_t{1} << 24;
+
+    /**
+     * @brief Create a builder for a graph with numVertices vertices
+     * @param path the path of the CSR file to create
+     * @param numVertices the number of vertices in the graph
+     * @param isDirected if false, every added edge is added in both directions
+     * @param maxEdgesInMemory the maximum number of edges to keep in memory before spilling a run to the disk
+     * @throw invalid_argument if numVertices does not fit in 32 bits or maxEdgesInMemory is 0
+     */
+    CsrBuilder(string path, size_t numVertices, bool isDirected = true, size_t maxEdgesInMemory = DEFAULT_MAX_EDGES_IN_MEMORY);
+
+    CsrBuilder(const CsrBuilder&) = delete;
+    CsrBuilder& operator=(const CsrBuilder&) = delete;
+
+    /**
+     * @brief remove the run files that were not merged yet
+     */
+    ~CsrBuilder();
+
+    /**
+     * @brief Add the edge (u, v) with the given weight
+     * @throw invalid_argument if u or v are not in the graph, u == v, or weight is NO_EDGE
+     * @throw logic_error if finish() was already called
+     * @throw runtime_error if a run can not be written to the disk
+     */
+    void addEdge(size_t u, size_t v, int weight = 1);
+
+    /**
+     * @brief Merge all the edges into the CSR file
+     * @throw invalid_argument if the same edge was added twice
+     * @throw logic_error if finish() was already called
+     * @throw runtime_error if the file can not be written
+     */
+    void finish();
+
+    /**
+     * @brief get the number of runs that were spilled to the disk so far
+     */
+    size_t getNumRuns() const { return runPaths.size(); }
+
+   private:
+    string path;
+    size_t numVertices;
+    bool isDirected;
+    bool isWeighted;
+    bool haveNegativeEdgeWeight;
+    size_t maxEdgesInMemory;
+    size_t numEdges;
+    bool finished;
+    vector<CsrEdge> buffer;
+    vector<string> runPaths;
+
+    /**
+     * @brief sort the buffer and write it to a new run file
+     */
+    void spill();
+
+    /**
+     * @brief add a single directed edge to the buffer, spill the buffer if it is full
+     */
+    void push(uint32_t from, uint32_t to, int32_t weight);
+};
+
+/**
+ * @brief A read-only graph stored in a CSR file created by CsrBuilder, memory mapped instead of loaded to the RAM.
+ *
+ * The graph supports the same neighbor iteration as the algorithms use:
+ * for (auto [v, w] : g.neighbors(u)) { ... }
+ */
+class MappedCsrGraph {
+   public:
+    /**
+     * @brief a range over the out edges of a vertex, every element is a (target, weight) pair
+     */
+    class NeighborRange {
+       public:
+        class Iterator {
+           public:
+            Iterator(const uint32_t* targets, const int32_t* weights, size_t i) : targets(targets), weights(weights), i(i) {}
+            pair<size_t, int> operator*() const { return {targets[i], weights[i]}; }
+            Iterator& operator++() {
+                i++;
+                return *this;
+            }
+            bool operator!=(const Iterator& other) const { return i != other.i; }
+
+           private:
+            const uint32_t* targets;
+            const int32_t* weights;
+            size_t i;
+        };
+
+        NeighborRange(const uint32_t* targets, const int32_t* weights, size_t first, size_t last)
+            : targets(targets), weights(weights), first(first), last(last) {}
+        Iterator begin() const { return {targets, weights, first}; }
+        Iterator end() const { return {targets, weights, last}; }
+        size_t size() const { return last - first; }
+
+       private:
+        const uint32_t* targets;
+        const int32_t* weights;
+        size_t first;
+        size_t last;
+    };
+
+    /**
+     * @brief Map a CSR file to the memory
+     * @param path the path of a file created by CsrBuilder
+     * @throw runtime_error if the file can not be opened or is not a valid CSR file
+     *  (the sizes in the header don't match the file, the offsets are not sorted or a target is not a vertex)
+     */
+    explicit MappedCsrGraph(const string& path);
+
+    MappedCsrGraph(const MappedCsrGraph&) = delete;
+    MappedCsrGraph& operator=(const MappedCsrGraph&) = delete;
+
+    /**
+     * @brief unmap the file
+     */
+    ~MappedCsrGraph();
+
+    size_t getNumVertices() const { return numVertices; }
+    size_t getNumEdges() const { return numEdges; }
+    bool isDirectedGraph() const { return isDirected; }
+    bool isWeightedGraph() const { return isWeighted; }
+    bool isHaveNegativeEdgeWeight() const { return haveNegativeEdgeWeight; }
+
+    /**
+     * @brief get the out edges of the vertex u
+     * @param u the vertex (must be < |V|)
+     * @return NeighborRange the (target, weight) pairs of the out edges of u, sorted by target
+     */
+    NeighborRange neighbors(size_t u) const { return {targets, weights, offsets[u], offsets[u + 1]}; }
+
+   private:
+    void* data;
+    size_t size;
+    size_t numVertices;
+    size_t numEdges;
+    bool isDirected;
+    bool isWeighted;
+    bool haveNegativeEdgeWeight;
+    const uint64_t* offsets;
+    const uint32_t* targets;
+    const int32_t* weights;
+};
+
+}  // namespace shayg
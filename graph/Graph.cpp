@@ -4,15 +4,32 @@
  */
 #include "Graph.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <map>
+#include <queue>
 #include <stdexcept>
 
 using namespace shayg;
 
 using std::invalid_argument;
 
+// the last revision number that was given to a graph
+std::atomic<uint64_t> lastRevision{0};
+
+// ~~~ declare the helper functions ~~~
+
+size_t undirectedDegree(const Graph& g, size_t u);
+vector<size_t> bfsOrder(const Graph& g, const vector<size_t>& seeds, bool byDegree);
+vector<size_t> degreeOrder(const Graph& g);
+vector<size_t> rcmOrder(const Graph& g);
+vector<size_t> communityOrder(const Graph& g);
+
 void Graph::loadGraph(const vector<vector<int>>& adjMat) {
     this->adjMat = adjMat;
+    this->labels.clear();  // a new graph is stored in its original order
+    this->positions.clear();
     /*
      * update the isWeighted and haveNegativeEdgeWeight fields.
      * create an deep copy of the adjacency list.
@@ -41,6 +58,14 @@ void Graph::printGraph(std::ostream& out) const {
 }
 
 void Graph::printAdjMat(std::ostream& out) const {
+    // always print the matrix with the original ids
+    if (isReordered()) {
+        Graph original = *this;
+        original.reorder(VertexOrder::ORIGINAL);
+        original.printAdjMat(out);
+        return;
+    }
+
     for (size_t i = 0; i < getNumVertices() - 1; i++) {
         out << "[";
         for (size_t j = 0; j < getNumVertices() - 1; j++) {
@@ -77,11 +102,17 @@ void Graph::updateData() {
     this->isWeighted = false;
     this->haveNegativeEdgeWeight = false;
     this->numEdges = 0;
+    this->maxEdgeWeight = 0;
+    this->revision = ++lastRevision;
+    this->adjList.assign(getNumVertices(), {});
+    this->inAdjList.assign(getNumVertices(), {});
 
     for (size_t i = 0; i < getNumVertices(); i++) {
         for (size_t j = 0; j < getNumVertices(); j++) {
             if (adjMat[i][j] != NO_EDGE) {
                 this->numEdges++;
+                this->adjList[i].emplace_back(j, adjMat[i][j]);
+                this->inAdjList[j].emplace_back(i, adjMat[i][j]);  // i grows in the outer loop, so the in-lists stay sorted
 
                 if (adjMat[i][j] != 1) {
                     this->isWeighted = true;
@@ -91,6 +122,10 @@ void Graph::updateData() {
                     this->haveNegativeEdgeWeight = true;
                 }
 
+                if (this->numEdges == 1 || adjMat[i][j] > this->maxEdgeWeight) {
+                    this->maxEdgeWeight = adjMat[i][j];
+                }
+
                 if (adjMat[i][j] != adjMat[j][i]) {
                     this->isDirected = true;
                 }
@@ -127,6 +162,16 @@ void Graph::modifyEdgeWeights(const Graph& other, const function<int(int, int)>&
         throw std::invalid_argument("The two graphs have different number of vertices.");
     }
 
+    // if the graphs store their vertices in different orders, combine the edges with the same original ids
+    if (this->labels != other.labels) {
+        Graph aligned = other;
+        aligned.adjMat = other.matrixInOrderOf(*this);
+        aligned.labels = this->labels;
+        aligned.positions = this->positions;
+        modifyEdgeWeights(aligned, func);
+        return;
+    }
+
     for (size_t u = 0; u < getNumVertices(); u++) {
         for (size_t v = 0; v < getNumVertices(); v++) {
             if (adjMat[u][v] == NO_EDGE && other.adjMat[u][v] == NO_EDGE) {  // if they are both NO_EDGE - the result edge is NO_EDGE
@@ -198,6 +243,15 @@ Graph Graph::operator*(const Graph& other) const {
         throw std::invalid_argument("The two graphs have different number of vertices.");
     }
 
+    // if the graphs store their vertices in different orders, multiply the matrices with the same original ids
+    if (this->labels != other.labels) {
+        Graph aligned = other;
+        aligned.adjMat = other.matrixInOrderOf(*this);
+        aligned.labels = this->labels;
+        aligned.positions = this->positions;
+        return *this * aligned;
+    }
+
     Graph g = *this;
 
     // do matrix multiplication on the adjacency matrices
@@ -227,6 +281,15 @@ Graph Graph::operator*(const Graph& other) const {
 }
 
 bool Graph::operator<(const Graph& other) const {
+    // the comparison is defined on the matrices with the original ids
+    if (this->isReordered() || other.isReordered()) {
+        Graph a = *this;
+        Graph b = other;
+        a.reorder(VertexOrder::ORIGINAL);
+        b.reorder(VertexOrder::ORIGINAL);
+        return a < b;
+    }
+
     // if they both empty graphs (no vertices and edges) return false
     if (this->adjMat.empty() && other.adjMat.empty()) {
         return false;
@@ -274,6 +337,217 @@ bool Graph::operator<(const Graph& other) const {
     return getNumVertices() < other.getNumVertices();
 }
 
+// ~~~ vertex reordering ~~~
+
+void Graph::reorder(VertexOrder strategy) {
+    size_t n = getNumVertices();
+
+    // newOrder[k] is the current (internal) id of the vertex that will be stored at index k
+    vector<size_t> newOrder;
+    switch (strategy) {
+        case VertexOrder::ORIGINAL:
+            if (!isReordered()) {
+                return;
+            }
+            newOrder = positions;  // positions[k] is the internal id of the original vertex k
+            break;
+        case VertexOrder::RCM:
+            newOrder = rcmOrder(*this);
+            break;
+        case VertexOrder::DEGREE:
+            newOrder = degreeOrder(*this);
+            break;
+        case VertexOrder::BFS: {
+            vector<size_t> seeds(n);
+            for (size_t i = 0; i < n; i++) {
+                seeds[i] = i;
+            }
+            newOrder = bfsOrder(*this, seeds, false);
+            break;
+        }
+        case VertexOrder::COMMUNITY:
+            newOrder = communityOrder(*this);
+            break;
+    }
+
+    // newPosition[u] is the index the vertex u will be stored at
+    vector<size_t> newPosition(n);
+    for (size_t k = 0; k < n; k++) {
+        newPosition[newOrder[k]] = k;
+    }
+    vector<vector<int>> newMat(n, vector<int>(n, NO_EDGE));
+    for (size_t k = 0; k < n; k++) {
+        for (auto [v, w] : adjList[newOrder[k]]) {
+            newMat[k][newPosition[v]] = w;
+        }
+    }
+
+    vector<size_t> newLabels(n);
+    bool identity = true;
+    for (size_t k = 0; k < n; k++) {
+        newLabels[k] = toOriginalId(newOrder[k]);
+        identity = identity && newLabels[k] == k;
+    }
+
+    this->adjMat = std::move(newMat);
+    if (identity) {
+        this->labels.clear();
+        this->positions.clear();
+    } else {
+        this->positions.assign(n, 0);
+        for (size_t k = 0; k < n; k++) {
+            this->positions[newLabels[k]] = k;
+        }
+        this->labels = std::move(newLabels);
+    }
+
+    updateData();
+}
+
+vector<vector<int>> Graph::matrixInOrderOf(const Graph& reference) const {
+    size_t n = getNumVertices();
+    vector<vector<int>> mat(n, vector<int>(n, NO_EDGE));
+    for (size_t u = 0; u < n; u++) {
+        size_t newU = reference.toInternalId(toOriginalId(u));
+        for (auto [v, w] : adjList[u]) {
+            mat[newU][reference.toInternalId(toOriginalId(v))] = w;
+        }
+    }
+    return mat;
+}
+
+/**
+ * @brief the number of edges that touch u (in-edges + out-edges)
+ */
+size_t undirectedDegree(const Graph& g, size_t u) {
+    return g.neighbors(u).size() + g.inNeighbors(u).size();
+}
+
+/**
+ * @brief BFS over all the vertices, ignoring the direction of the edges
+ * @param g the graph
+ * @param seeds the order to try the start vertices in (a new BFS starts from every seed that was not discovered yet)
+ * @param byDegree if true, the neighbors of a vertex are visited by increasing degree (Cuthill-McKee), otherwise by id
+ * @return the vertices in the order they were discovered
+ */
+vector<size_t> bfsOrder(const Graph& g, const vector<size_t>& seeds, bool byDegree) {
+    size_t n = g.getNumVertices();
+    vector<bool> visited(n, false);
+    vector<size_t> order;
+    order.reserve(n);
+
+    for (size_t seed : seeds) {
+        if (visited[seed]) {
+            continue;
+        }
+        visited[seed] = true;
+        order.push_back(seed);
+
+        // the order vector is also the BFS queue
+        for (size_t head = order.size() - 1; head < order.size(); head++) {
+            size_t u = order[head];
+            size_t firstNew = order.size();
+            for (const vector<pair<size_t, int>>* edges : {&g.neighbors(u), &g.inNeighbors(u)}) {
+                for (auto [v, w] : *edges) {
+                    if (!visited[v]) {
+                        visited[v] = true;
+                        order.push_back(v);
+                    }
+                }
+            }
+            if (byDegree) {
+                std::stable_sort(order.begin() + static_cast<std::ptrdiff_t>(firstNew), order.end(),
+                                 [&g](size_t a, size_t b) { return undirectedDegree(g, a) < undirectedDegree(g, b); });
+            }
+        }
+    }
+    return order;
+}
+
+/**
+ * @brief the vertices sorted by their degree, the highest degree first
+ */
+vector<size_t> degreeOrder(const Graph& g) {
+    vector<size_t> order(g.getNumVertices());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&g](size_t a, size_t b) { return undirectedDegree(g, a) > undirectedDegree(g, b); });
+    return order;
+}
+
+/**
+ * @brief reverse Cuthill-McKee order: every component starts from its lowest degree vertex,
+ * the neighbors are visited by increasing degree, and the final order is reversed
+ */
+vector<size_t> rcmOrder(const Graph& g) {
+    vector<size_t> seeds = degreeOrder(g);
+    std::reverse(seeds.begin(), seeds.end());  // the lowest degree first
+    std::stable_sort(seeds.begin(), seeds.end(), [&g](size_t a, size_t b) { return undirectedDegree(g, a) < undirectedDegree(g, b); });
+
+    vector<size_t> order = bfsOrder(g, seeds, true);
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+/**
+ * @brief group the vertices by communities, so vertices that are connected to each other are stored close to each other.
+ * The communities are found with label propagation (every vertex takes the most common label of its neighbors),
+ * a cheap alternative to the modularity based merging of Rabbit order.
+ */
+vector<size_t> communityOrder(const Graph& g) {
+    constexpr size_t MAX_ROUNDS = 10;
+    size_t n = g.getNumVertices();
+
+    vector<size_t> label(n);
+    for (size_t i = 0; i < n; i++) {
+        label[i] = i;
+    }
+
+    for (size_t round = 0; round < MAX_ROUNDS; round++) {
+        bool changed = false;
+        for (size_t u = 0; u < n; u++) {
+            std::map<size_t, size_t> counts;
+            for (const vector<pair<size_t, int>>* edges : {&g.neighbors(u), &g.inNeighbors(u)}) {
+                for (auto [v, w] : *edges) {
+                    counts[label[v]]++;
+                }
+            }
+            size_t best = label[u];
+            size_t bestCount = 0;
+            for (auto [l, count] : counts) {  // the map is sorted, so ties go to the smallest label
+                if (count > bestCount) {
+                    best = l;
+                    bestCount = count;
+                }
+            }
+            if (best != label[u]) {
+                label[u] = best;
+                changed = true;
+            }
+        }
+        if (!changed) {
+            break;
+        }
+    }
+
+    // order the communities by the first time one of their vertices is discovered in BFS, keep the BFS order inside a community
+    vector<size_t> seeds(n);
+    for (size_t i = 0; i < n; i++) {
+        seeds[i] = i;
+    }
+    vector<size_t> order = bfsOrder(g, seeds, false);
+    vector<size_t> communityRank(n, n);
+    size_t nextRank = 0;
+    for (size_t v : order) {
+        if (communityRank[label[v]] == n) {
+            communityRank[label[v]] = nextRank++;
+        }
+    }
+    std::stable_sort(order.begin(), order.end(), [&label, &communityRank](size_t a, size_t b) { return communityRank[label[a]] < communityRank[label[b]]; });
+    return order;
+}
+
 std::ostream& shayg::operator<<(std::ostream& os, const Graph& graph) {  //~~~ the shayg:: is needed because the operator is defined in the shayg namespace ~~~//
     // graph.printGraph(os);
     graph.printAdjMat(os);
@@ -4,12 +4,15 @@
  */
 #pragma once
 
+#include <cstdint>
 #include <functional>
 #include <iostream>
 #include <limits>
+#include <utility>
 #include <vector>
 
 using std::function;
+using std::pair;
 using std::vector;
 
 constexpr int INF = std::numeric_limits<int>::max();  // represent infinity
@@ -17,16 +20,36 @@ constexpr int NO_EDGE = 0;                            // represent no edge betwe
 
 namespace shayg {
 
+/**
+ * @brief the strategies that Graph::reorder can use to relabel the vertices
+ */
+enum class VertexOrder {
+    ORIGINAL,  // go back to the ids the graph was loaded with
+    RCM,       // reverse Cuthill-McKee: BFS from a low degree vertex, visiting the neighbors by increasing degree, reversed
+    DEGREE,    // by degree (in + out), the highest degree first
+    BFS,       // the BFS discovery order (ignoring the direction of the edges)
+    COMMUNITY  // group the vertices of every community (found by label propagation), in BFS order inside the community
+};
+
 /**
  * @brief an abstract class that represents a graph as an adjacency matrix
  */
 class Graph {
    private:
     vector<vector<int>> adjMat;
+    vector<vector<pair<size_t, int>>> adjList;    // the (neighbor, weight) pairs of every vertex, sorted by neighbor
+    vector<vector<pair<size_t, int>>> inAdjList;  // the transposed adjacency list: the (source, weight) pairs of the in edges of every vertex
     bool isDirected;
     bool isWeighted;
     bool haveNegativeEdgeWeight;
     size_t numEdges;
+    int maxEdgeWeight = 0;  // the largest weight of an edge (0 if there are no edges)
+    uint64_t revision = 0;  // a new number every time the graph changes (0 until it is loaded)
+
+    // after reorder(): labels[i] is the original id of the vertex stored at index i, and positions is the inverse permutation.
+    // both are empty when the vertices are stored in their original order.
+    vector<size_t> labels;
+    vector<size_t> positions;
 
     /**
      * @brief modify the weights of the edges in the graph using a function
@@ -46,10 +69,19 @@ class Graph {
 
     /**
      * @brief update the isWeighted and haveNegativeEdgeWeight fields if needed.
-     * check if a directed graph is a symmetric matrix
+     * check if a directed graph is a symmetric matrix.
+     * rebuild the adjacency list and the transposed adjacency list from the adjacency matrix.
      */
     void updateData();
 
+    /**
+     * @brief get the adjacency matrix of this graph, with the vertices stored in the same order as in the reference graph
+     * (used to combine two graphs that were reordered differently)
+     * @param reference the graph that its order will be used
+     * @return the permuted adjacency matrix
+     */
+    vector<vector<int>> matrixInOrderOf(const Graph& reference) const;
+
    public:
     /**
      * @brief Load the graph from an adjacency matrix
@@ -84,10 +116,49 @@ class Graph {
 
     /**
      * @brief return the adjacency matrix of the graph
+     * @note after reorder(), the rows and the columns are in the new (internal) order. use toOriginalId to translate them.
      * @return vector<vector<int>> the adjacency matrix
      */
     const vector<vector<int>>& getGraph() const { return this->adjMat; }
-    vector<vector<int>>& getGraph() { return this->adjMat; }
+
+    /**
+     * @brief get the neighbors of a vertex, without scanning its row in the adjacency matrix
+     * can be used like this: for (auto [v, w] : g.neighbors(u)) { ... }
+     * @param u the vertex (must be < |V|)
+     * @return the (neighbor, weight) pairs of the out edges of u, sorted by neighbor
+     */
+    const vector<pair<size_t, int>>& neighbors(size_t u) const { return this->adjList[u]; }
+
+    /**
+     * @brief get the in-neighbors of a vertex (the vertices with an edge to it), without scanning its column in the adjacency matrix
+     * can be used like this: for (auto [u, w] : g.inNeighbors(v)) { ... }
+     * @param v the vertex (must be < |V|)
+     * @return the (source, weight) pairs of the in edges of v, sorted by source
+     */
+    const vector<pair<size_t, int>>& inNeighbors(size_t v) const { return this->inAdjList[v]; }
+
+    /**
+     * @brief Relabel the vertices for cache locality: compute a permutation with the given strategy and store the
+     * adjacency matrix and lists in the new order. The algorithms keep getting and returning the original ids.
+     * @param strategy the order to use. VertexOrder::ORIGINAL restores the order the graph was loaded with.
+     */
+    void reorder(VertexOrder strategy);
+
+    /**
+     * @brief check if the vertices are stored in an order other than the original one
+     */
+    bool isReordered() const { return !labels.empty(); }
+
+    /**
+     * @brief translate an internal vertex id (an index in getGraph() and neighbors()) to the id the graph was loaded with
+     */
+    size_t toOriginalId(size_t internalId) const { return labels.empty() ? internalId : labels[internalId]; }
+
+    /**
+     * @brief translate the id the graph was loaded with to the internal vertex id (an index in getGraph() and neighbors())
+     */
+    size_t toInternalId(size_t originalId) const { return positions.empty() ? originalId : positions[originalId]; }
+
     /**
      * @brief get the number of vertices and edges in the graph
      * @return size_t the number of vertices in the graph (|V|)
@@ -118,6 +189,19 @@ class Graph {
      */
     bool isHaveNegativeEdgeWeight() const { return haveNegativeEdgeWeight; }
 
+    /**
+     * @brief get the largest weight of an edge in the graph (kept up to date with the graph, so it is O(1))
+     * @return int the largest edge weight, 0 if the graph has no edges
+     */
+    int getMaxEdgeWeight() const { return maxEdgeWeight; }
+
+    /**
+     * @brief get the revision of the graph - a number that changes every time the graph is changed (loadGraph, reorder and the operators),
+     * and is never reused by another graph (0 before the first loadGraph). a copy of a graph has the same revision as the original until one of them changes.
+     * used to check if data that was computed from the graph (like a LandmarkIndex) is still valid.
+     */
+    uint64_t getRevision() const { return revision; }
+
     // ~~~ Operators overloading ~~~
     /**
      * @brief Unary + operator
@@ -0,0 +1,529 @@
+/**
+ * @author Shay Gali
+ * @link shay.gali@msmail.ariel.ac.il
+ */
+#include "GraphSerializer.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+using namespace shayg;
+
+using std::invalid_argument;
+using std::runtime_error;
+
+constexpr char MAGIC[] = {'S', 'G', 'G'};
+constexpr uint8_t FORMAT_VERSION = 1;
+
+// graph flags
+constexpr uint8_t FLAG_DIRECTED = 1;
+constexpr uint8_t FLAG_WEIGHTED = 2;
+constexpr uint8_t FLAG_NEGATIVE = 4;
+
+// LZ codec parameters
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t MAX_OFFSET = 65535;
+constexpr size_t HASH_BITS = 12;
+constexpr size_t NO_POSITION = std::numeric_limits<size_t>::max();
+// a sequence of the codec is at least 3 bytes (token and offset) and its match adds at most 255 bytes for every length byte,
+// so a compressed block is less than MAX_LZ_RATIO times bigger when it is decompressed
+constexpr size_t MAX_LZ_RATIO = 255;
+
+// the longest varints: a 64 bits number (a column delta) and a zigzag encoded weight
+constexpr size_t MAX_VARINT_BYTES = 10;
+constexpr size_t MAX_WEIGHT_BYTES = 5;
+
+// ~~~ declare the helper functions ~~~
+
+void writeVarint(vector<uint8_t>& out, uint64_t value);
+void writeVarint(std::ostream& os, uint64_t value);
+uint64_t readVarint(const vector<uint8_t>& in, size_t& pos);
+uint64_t readVarint(std::istream& is);
+size_t streamEnd(std::istream& is);
+
+uint32_t zigzagEncode(int value);
+int zigzagDecode(uint32_t value);
+
+vector<uint8_t> encodeRows(const vector<vector<int>>& adjMat, size_t firstRow, size_t numRows);
+void writeLength(vector<uint8_t>& out, size_t length);
+size_t readLength(const vector<uint8_t>& in, size_t& pos, size_t length);
+
+// ~~~ implement the functions ~~~
+
+void GraphSerializer::write(const Graph& g, std::ostream& os, Codec codec, size_t rowsPerBlock) {
+    if (rowsPerBlock == 0) {
+        throw invalid_argument("rowsPerBlock must be positive.");
+    }
+
+    // the file always stores the graph with its original ids
+    Graph original = g;
+    original.reorder(VertexOrder::ORIGINAL);
+    const vector<vector<int>>& adjMat = original.getGraph();
+    size_t n = g.getNumVertices();
+    size_t numBlocks = (n + rowsPerBlock - 1) / rowsPerBlock;
+
+    // encode (and compress) all the blocks before writing, the directory needs their sizes
+    vector<vector<uint8_t>> payloads(numBlocks);
+    vector<Codec> codecs(numBlocks, Codec::NONE);
+    vector<size_t> rawSizes(numBlocks);
+    for (size_t b = 0; b < numBlocks; b++) {
+        size_t firstRow = b * rowsPerBlock;
+        vector<uint8_t> raw = encodeRows(adjMat, firstRow, std::min(rowsPerBlock, n - firstRow));
+        rawSizes[b] = raw.size();
+
+        if (codec == Codec::LZ) {
+            vector<uint8_t> compressed = compress(raw);
+            if (compressed.size() < raw.size()) {  // keep the block raw if compression does not help
+                payloads[b] = std::move(compressed);
+                codecs[b] = Codec::LZ;
+                continue;
+            }
+        }
+        payloads[b] = std::move(raw);
+    }
+
+    // header
+    uint8_t flags = 0;
+    if (g.isDirectedGraph()) {
+        flags |= FLAG_DIRECTED;
+    }
+    if (g.isWeightedGraph()) {
+        flags |= FLAG_WEIGHTED;
+    }
+    if (g.isHaveNegativeEdgeWeight()) {
+        flags |= FLAG_NEGATIVE;
+    }
+    os.write(MAGIC, sizeof(MAGIC));
+    os.put(static_cast<char>(FORMAT_VERSION));
+    os.put(static_cast<char>(flags));
+    writeVarint(os, n);
+    writeVarint(os, g.getNumEdges());
+    writeVarint(os, rowsPerBlock);
+    writeVarint(os, numBlocks);
+
+    // block directory
+    for (size_t b = 0; b < numBlocks; b++) {
+        os.put(static_cast<char>(codecs[b]));
+        writeVarint(os, rawSizes[b]);
+        writeVarint(os, payloads[b].size());
+    }
+
+    // block payloads
+    for (const vector<uint8_t>& payload : payloads) {
+        os.write(reinterpret_cast<const char*>(payload.data()), static_cast<std::streamsize>(payload.size()));
+    }
+
+    if (!os) {
+        throw runtime_error("Failed to write the graph.");
+    }
+}
+
+Graph GraphSerializer::read(std::istream& is) {
+    Header header = readHeader(is);
+
+    vector<vector<int>> adjMat;
+    adjMat.reserve(header.numVertices);
+    for (size_t b = 0; b < header.blocks.size(); b++) {
+        vector<vector<int>> rows = readBlock(is, header, b);
+        for (vector<int>& row : rows) {
+            adjMat.push_back(std::move(row));
+        }
+    }
+
+    Graph g;
+    g.loadGraph(adjMat);
+
+    // the flags in the header must agree with the decoded data
+    if (g.getNumEdges() != header.numEdges || g.isDirectedGraph() != header.isDirected ||
+        g.isWeightedGraph() != header.isWeighted || g.isHaveNegativeEdgeWeight() != header.haveNegativeEdgeWeight) {
+        throw runtime_error("Corrupted graph: the header does not match the adjacency data.");
+    }
+    return g;
+}
+
+GraphSerializer::Header GraphSerializer::readHeader(std::istream& is) {
+    char magic[sizeof(MAGIC)];
+    is.read(magic, sizeof(MAGIC));
+    if (!is || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) {
+        throw runtime_error("Not a serialized graph.");
+    }
+
+    int version = is.get();
+    if (version != FORMAT_VERSION) {
+        throw runtime_error("Unsupported graph format version " + std::to_string(version) + ".");
+    }
+    int flags = is.get();
+    if (flags == EOF) {
+        throw runtime_error("Corrupted graph: truncated header.");
+    }
+
+    Header header{};
+    header.isDirected = (flags & FLAG_DIRECTED) != 0;
+    header.isWeighted = (flags & FLAG_WEIGHTED) != 0;
+    header.haveNegativeEdgeWeight = (flags & FLAG_NEGATIVE) != 0;
+    header.numVertices = readVarint(is);
+    header.numEdges = readVarint(is);
+    header.rowsPerBlock = readVarint(is);
+    size_t numBlocks = readVarint(is);
+
+    // the sizes in the header are checked against the size of the data before anything is allocated for them.
+    // every row has at least one byte (its degree) in a block, and a block is at most MAX_LZ_RATIO times its stored size
+    size_t available = streamEnd(is) - static_cast<size_t>(is.tellg());
+    if (header.numVertices / MAX_LZ_RATIO > available) {
+        throw runtime_error("Corrupted graph: too many vertices for the size of the data.");
+    }
+    if (header.rowsPerBlock == 0 || numBlocks != (header.numVertices + header.rowsPerBlock - 1) / header.rowsPerBlock) {
+        throw runtime_error("Corrupted graph: invalid block layout.");
+    }
+    if (numBlocks > available / 3) {  // a directory entry is at least 3 bytes
+        throw runtime_error("Corrupted graph: truncated block directory.");
+    }
+
+    // a row is its degree and at most |V| edges, every edge is a column delta and a weight
+    size_t maxRowSize = MAX_VARINT_BYTES + header.numVertices * (MAX_VARINT_BYTES + MAX_WEIGHT_BYTES);
+    header.blocks.resize(numBlocks);
+    for (size_t b = 0; b < numBlocks; b++) {
+        BlockInfo& block = header.blocks[b];
+        int codec = is.get();
+        if (codec != static_cast<int>(Codec::NONE) && codec != static_cast<int>(Codec::LZ)) {
+            throw runtime_error("Corrupted graph: unknown codec in block " + std::to_string(b) + ".");
+        }
+        block.codec = static_cast<Codec>(codec);
+        block.firstRow = b * header.rowsPerBlock;
+        block.numRows = std::min(header.rowsPerBlock, header.numVertices - block.firstRow);
+        block.rawSize = readVarint(is);
+        block.storedSize = readVarint(is);
+
+        bool validRawSize = block.rawSize >= block.numRows && block.rawSize / block.numRows <= maxRowSize;
+        bool validStoredSize = block.codec == Codec::NONE ? block.storedSize == block.rawSize : block.rawSize / MAX_LZ_RATIO <= block.storedSize;
+        if (!validRawSize || !validStoredSize) {
+            throw runtime_error("Corrupted graph: invalid size of block " + std::to_string(b) + ".");
+        }
+    }
+
+    // the payloads start right after the directory, and must all be in the stream
+    auto offset = static_cast<size_t>(is.tellg());
+    size_t end = streamEnd(is);
+    for (size_t b = 0; b < numBlocks; b++) {
+        BlockInfo& block = header.blocks[b];
+        if (block.storedSize > end - offset) {
+            throw runtime_error("Corrupted graph: block " + std::to_string(b) + " is truncated.");
+        }
+        block.offset = offset;
+        offset += block.storedSize;
+    }
+    return header;
+}
+
+vector<vector<int>> GraphSerializer::readBlock(std::istream& is, const Header& header, size_t blockIndex) {
+    if (blockIndex >= header.blocks.size()) {
+        throw std::out_of_range("Invalid block index " + std::to_string(blockIndex) + ".");
+    }
+    const BlockInfo& block = header.blocks[blockIndex];
+
+    size_t end = streamEnd(is);
+    if (block.offset > end || block.storedSize > end - block.offset) {
+        throw runtime_error("Corrupted graph: block " + std::to_string(blockIndex) + " is truncated.");
+    }
+    vector<uint8_t> stored(block.storedSize);
+    is.seekg(static_cast<std::streamoff>(block.offset));
+    is.read(reinterpret_cast<char*>(stored.data()), static_cast<std::streamsize>(stored.size()));
+    if (!is) {
+        throw runtime_error("Corrupted graph: block " + std::to_string(blockIndex) + " is truncated.");
+    }
+
+    return decodeBlock(stored, block, header.numVertices);
+}
+
+vector<vector<int>> GraphSerializer::decodeBlock(const vector<uint8_t>& stored, const BlockInfo& block, size_t numVertices) {
+    vector<uint8_t> raw = block.codec == Codec::LZ ? decompress(stored, block.rawSize) : stored;
+    if (raw.size() != block.rawSize || raw.size() < block.numRows) {  // every row has at least its degree
+        throw runtime_error("Corrupted graph: wrong block size.");
+    }
+
+    vector<vector<int>> rows(block.numRows, vector<int>(numVertices, NO_EDGE));
+    size_t pos = 0;
+    for (size_t r = 0; r < block.numRows; r++) {
+        size_t degree = readVarint(raw, pos);
+        size_t v = 0;  // the next column that can hold an edge
+        for (size_t i = 0; i < degree; i++) {
+            uint64_t gap = readVarint(raw, pos);
+            if (gap >= numVertices - v) {  // checked before adding, so a huge gap can't wrap around
+                throw runtime_error("Corrupted graph: invalid edge in row " + std::to_string(block.firstRow + r) + ".");
+            }
+            v += gap;
+            int weight = zigzagDecode(static_cast<uint32_t>(readVarint(raw, pos)));
+            if (weight == NO_EDGE) {
+                throw runtime_error("Corrupted graph: invalid edge in row " + std::to_string(block.firstRow + r) + ".");
+            }
+            rows[r][v] = weight;
+            v++;
+        }
+    }
+
+    if (pos != raw.size()) {
+        throw runtime_error("Corrupted graph: trailing data in block.");
+    }
+    return rows;
+}
+
+vector<uint8_t> GraphSerializer::compress(const vector<uint8_t>& src) {
+    /*
+    LZ77 with a single hash table of the last position of every 4 bytes sequence.
+    The output is a list of sequences, every sequence is:
+    token (literals length << 4 | match length - MIN_MATCH), [extra literals length], literals, match offset (2 bytes), [extra match length]
+    A length of 15 in the token means that the rest of the length follows as 255 bytes.
+    The last sequence has only literals.
+    */
+    size_t n = src.size();
+    vector<uint8_t> out;
+    out.reserve(n / 2 + 16);
+    vector<size_t> table(size_t{1} << HASH_BITS, NO_POSITION);
+
+    auto read32 = [&src](size_t i) {
+        uint32_t value = 0;
+        std::memcpy(&value, &src[i], sizeof(value));
+        return value;
+    };
+
+    auto emitLiterals = [&out, &src](size_t tokenPos, size_t anchor, size_t length) {
+        if (length >= 15) {
+            out[tokenPos] |= 15 << 4;
+            writeLength(out, length - 15);
+        } else {
+            out[tokenPos] |= static_cast<uint8_t>(length << 4);
+        }
+        out.insert(out.end(), src.begin() + static_cast<std::ptrdiff_t>(anchor), src.begin() + static_cast<std::ptrdiff_t>(anchor + length));
+    };
+
+    size_t anchor = 0;
+    size_t i = 0;
+    while (i + MIN_MATCH <= n) {
+        uint32_t sequence = read32(i);
+        size_t hash = (sequence * 2654435761U) >> (32 - HASH_BITS);
+        size_t candidate = table[hash];
+        table[hash] = i;
+
+        if (candidate == NO_POSITION || i - candidate > MAX_OFFSET || read32(candidate) != sequence) {
+            i++;
+            continue;
+        }
+
+        size_t length = MIN_MATCH;
+        while (i + length < n && src[candidate + length] == src[i + length]) {
+            length++;
+        }
+
+        size_t tokenPos = out.size();
+        out.push_back(0);
+        emitLiterals(tokenPos, anchor, i - anchor);
+
+        size_t offset = i - candidate;
+        out.push_back(static_cast<uint8_t>(offset & 0xFF));
+        out.push_back(static_cast<uint8_t>(offset >> 8));
+        if (length - MIN_MATCH >= 15) {
+            out[tokenPos] |= 15;
+            writeLength(out, length - MIN_MATCH - 15);
+        } else {
+            out[tokenPos] |= static_cast<uint8_t>(length - MIN_MATCH);
+        }
+
+        i += length;
+        anchor = i;
+    }
+
+    // the last literals
+    size_t tokenPos = out.size();
+    out.push_back(0);
+    emitLiterals(tokenPos, anchor, n - anchor);
+    return out;
+}
+
+vector<uint8_t> GraphSerializer::decompress(const vector<uint8_t>& src, size_t rawSize) {
+    if (rawSize / MAX_LZ_RATIO > src.size()) {
+        throw runtime_error("Corrupted block: wrong decompressed size.");
+    }
+    vector<uint8_t> out;
+    out.reserve(rawSize);
+
+    size_t pos = 0;
+    while (pos < src.size()) {
+        uint8_t token = src[pos++];
+
+        size_t literals = readLength(src, pos, token >> 4);
+        if (literals > src.size() - pos || out.size() + literals > rawSize) {
+            throw runtime_error("Corrupted block: literals out of range.");
+        }
+        out.insert(out.end(), src.begin() + static_cast<std::ptrdiff_t>(pos), src.begin() + static_cast<std::ptrdiff_t>(pos + literals));
+        pos += literals;
+
+        if (pos == src.size()) {  // the last sequence has no match
+            break;
+        }
+
+        if (src.size() - pos < 2) {
+            throw runtime_error("Corrupted block: truncated match offset.");
+        }
+        size_t offset = src[pos] | (static_cast<size_t>(src[pos + 1]) << 8);
+        pos += 2;
+        size_t length = readLength(src, pos, token & 15U) + MIN_MATCH;
+        if (offset == 0 || offset > out.size() || out.size() + length > rawSize) {
+            throw runtime_error("Corrupted block: match out of range.");
+        }
+
+        // copy byte by byte, the match may overlap the bytes it produces
+        size_t from = out.size() - offset;
+        for (size_t k = 0; k < length; k++) {
+            out.push_back(out[from + k]);
+        }
+    }
+
+    if (out.size() != rawSize) {
+        throw runtime_error("Corrupted block: wrong decompressed size.");
+    }
+    return out;
+}
+
+// ~~~ implement the helper functions ~~~
+
+// ~ varint ~
+
+/**
+ * @brief Append an unsigned number as a varint (7 bits per byte, the high bit marks that more bytes follow)
+ */
+void writeVarint(vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void writeVarint(std::ostream& os, uint64_t value) {
+    vector<uint8_t> bytes;
+    writeVarint(bytes, value);
+    os.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+}
+
+/**
+ * @brief Read a varint from the buffer, starting at pos. pos will point after the varint.
+ * @throw runtime_error if the varint is truncated or too long
+ */
+uint64_t readVarint(const vector<uint8_t>& in, size_t& pos) {
+    uint64_t value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        if (pos >= in.size()) {
+            throw runtime_error("Corrupted graph: truncated varint.");
+        }
+        uint8_t byte = in[pos++];
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+    }
+    throw runtime_error("Corrupted graph: varint is too long.");
+}
+
+uint64_t readVarint(std::istream& is) {
+    uint64_t value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        int byte = is.get();
+        if (byte == EOF) {
+            throw runtime_error("Corrupted graph: truncated varint.");
+        }
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+    }
+    throw runtime_error("Corrupted graph: varint is too long.");
+}
+
+/**
+ * @brief the position of the end of the stream. the stream stays at its current position
+ * @throw runtime_error if the stream can not seek
+ */
+size_t streamEnd(std::istream& is) {
+    std::streampos pos = is.tellg();
+    is.seekg(0, std::ios::end);
+    std::streampos end = is.tellg();
+    is.seekg(pos);
+    if (pos == std::streampos(-1) || end == std::streampos(-1) || !is) {
+        throw runtime_error("Failed to read the graph: the stream can not seek.");
+    }
+    return static_cast<size_t>(end);
+}
+
+/**
+ * @brief map signed numbers to unsigned numbers so small negative numbers get small codes (0, -1, 1, -2 -> 0, 1, 2, 3)
+ */
+uint32_t zigzagEncode(int value) {
+    return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+int zigzagDecode(uint32_t value) {
+    return static_cast<int>(value >> 1) ^ -static_cast<int>(value & 1);
+}
+
+// ~ rows encoding ~
+
+/**
+ * @brief Delta + varint encode the rows [firstRow, firstRow + numRows) of the adjacency matrix
+ * @return the encoded bytes. Every row is: number of edges, then (column - next free column, zigzag(weight)) for every edge.
+ */
+vector<uint8_t> encodeRows(const vector<vector<int>>& adjMat, size_t firstRow, size_t numRows) {
+    vector<uint8_t> out;
+    for (size_t u = firstRow; u < firstRow + numRows; u++) {
+        size_t degree = 0;
+        for (int weight : adjMat[u]) {
+            if (weight != NO_EDGE) {
+                degree++;
+            }
+        }
+        writeVarint(out, degree);
+
+        size_t next = 0;  // the next column that can hold an edge
+        for (size_t v = 0; v < adjMat[u].size(); v++) {
+            if (adjMat[u][v] != NO_EDGE) {
+                writeVarint(out, v - next);
+                writeVarint(out, zigzagEncode(adjMat[u][v]));
+                next = v + 1;
+            }
+        }
+    }
+    return out;
+}
+
+// ~ LZ lengths ~
+
+/**
+ * @brief write the part of a length that did not fit in the token, as a sequence of 255 bytes and a final byte < 255
+ */
+void writeLength(vector<uint8_t>& out, size_t length) {
+    while (length >= 255) {
+        out.push_back(255);
+        length -= 255;
+    }
+    out.push_back(static_cast<uint8_t>(length));
+}
+
+/**
+ * @brief read a length from the token nibble, and the extra bytes if the nibble is 15
+ */
+size_t readLength(const vector<uint8_t>& in, size_t& pos, size_t length) {
+    if (length != 15) {
+        return length;
+    }
+    while (true) {
+        if (pos >= in.size()) {
+            throw runtime_error("Corrupted block: truncated length.");
+        }
+        uint8_t byte = in[pos++];
+        length += byte;
+        if (byte != 255) {
+            return length;
+        }
+    }
+}
@@ -0,0 +1,132 @@
+/**
+ * @author Shay Gali
+ * @link shay.gali@msmail.ariel.ac.il
+ */
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "Graph.hpp"
+
+using std::vector;
+
+namespace shayg {
+
+/**
+ * @brief Compact binary format for the adjacency data of a Graph.
+ *
+ * The rows of the adjacency matrix are split into blocks of `rowsPerBlock` rows.
+ * Inside a block every row is written as its number of edges followed by (column delta, weight) pairs,
+ * where the columns are delta-encoded and all the numbers are varint-encoded (weights are zigzag-encoded first).
+ * Each block can then be compressed with a small LZ77 block codec.
+ *
+ * The file layout is:
+ * "SGG" magic, format version, graph flags, |V|, |E|, rowsPerBlock, number of blocks,
+ * a block directory (codec, raw size, stored size for every block) and then the block payloads.
+ * Because every block is encoded on its own, any block can be decoded without the others,
+ * so a graph can be partially loaded or decoded in parallel.
+ */
+class GraphSerializer {
+   public:
+    static constexpr size_t DEFAULT_ROWS_PER_BLOCK = 256;
+
+    /**
+     * @brief the codec used to store a block
+     */
+    enum class Codec : uint8_t {
+        NONE = 0,  // the delta + varint encoded rows as is
+        LZ = 1     // the encoded rows compressed with the LZ77 block codec
+    };
+
+    /**
+     * @brief information about one block of the file, as read from the block directory
+     */
+    struct BlockInfo {
+        Codec codec;
+        size_t firstRow;    // the index of the first row in the block
+        size_t numRows;     // the number of rows in the block
+        size_t rawSize;     // the size of the encoded rows before compression
+        size_t storedSize;  // the size of the block in the file
+        size_t offset;      // the position of the block payload in the stream
+    };
+
+    /**
+     * @brief the header of a serialized graph
+     */
+    struct Header {
+        size_t numVertices;
+        size_t numEdges;
+        bool isDirected;
+        bool isWeighted;
+        bool haveNegativeEdgeWeight;
+        size_t rowsPerBlock;
+        vector<BlockInfo> blocks;
+    };
+
+    /**
+     * @brief Write the graph to the output stream
+     * @param g the graph to write
+     * @param os the output stream (should be opened in binary mode)
+     * @param codec the codec to compress the blocks with. A block that does not get smaller is stored with Codec::NONE.
+     * @param rowsPerBlock the number of rows in each block
+     * @throw invalid_argument if rowsPerBlock is 0
+     */
+    static void write(const Graph& g, std::ostream& os, Codec codec = Codec::LZ, size_t rowsPerBlock = DEFAULT_ROWS_PER_BLOCK);
+
+    /**
+     * @brief Read a full graph from the input stream
+     * @param is the input stream, positioned at the start of the serialized graph
+     * @return Graph the graph that was written to the stream
+     * @throw runtime_error if the data is not a valid serialized graph
+     */
+    static Graph read(std::istream& is);
+
+    /**
+     * @brief Read only the header and the block directory
+     * @param is the input stream, positioned at the start of the serialized graph
+     * @return Header the header of the serialized graph. The block offsets are positions in the stream.
+     * @throw runtime_error if the data is not a valid serialized graph
+     */
+    static Header readHeader(std::istream& is);
+
+    /**
+     * @brief Read and decode a single block
+     * @param is the input stream (the same stream the header was read from)
+     * @param header the header returned from readHeader
+     * @param blockIndex the index of the block to decode
+     * @return the rows of the block (each row has |V| entries)
+     * @throw out_of_range if blockIndex is not a valid block
+     * @throw runtime_error if the block is corrupted
+     */
+    static vector<vector<int>> readBlock(std::istream& is, const Header& header, size_t blockIndex);
+
+    /**
+     * @brief Decode a block from its stored bytes. Does not touch any stream, so can be called from many threads at once.
+     * @param stored the bytes of the block as stored in the file
+     * @param block the directory entry of the block
+     * @param numVertices the number of vertices in the graph
+     * @return the rows of the block (each row has numVertices entries)
+     * @throw runtime_error if the block is corrupted
+     */
+    static vector<vector<int>> decodeBlock(const vector<uint8_t>& stored, const BlockInfo& block, size_t numVertices);
+
+    /**
+     * @brief Compress a buffer with the LZ77 block codec
+     * @param src the bytes to compress
+     * @return the compressed bytes
+     */
+    static vector<uint8_t> compress(const vector<uint8_t>& src);
+
+    /**
+     * @brief Decompress a buffer that was compressed with compress()
+     * @param src the compressed bytes
+     * @param rawSize the size of the original buffer
+     * @return the original bytes
+     * @throw runtime_error if the data is corrupted
+     */
+    static vector<uint8_t> decompress(const vector<uint8_t>& src, size_t rawSize);
+};
+
+}  // namespace shayg
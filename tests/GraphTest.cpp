@@ -2,13 +2,17 @@
  * @author Shay Gali
  * @link shay.gali@msmail.ariel.ac.il
  */
+#include <cstring>
+#include <fstream>
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
 #include <vector>
 
 #include "../algorithms/Algorithms.hpp"
+#include "../graph/CsrGraph.hpp"
 #include "../graph/Graph.hpp"
+#include "../graph/GraphSerializer.hpp"
 #include "doctest.h"
 
 using namespace shayg;
@@ -84,6 +88,107 @@ TEST_CASE("Test loadGraph") {
     }
 }
 
+TEST_CASE("Test neighbors and inNeighbors") {
+    Graph g;
+    vector<vector<int>> graph = {
+        // clang-format off
+        {NO_EDGE, 4,       -2     },
+        {NO_EDGE, NO_EDGE, 3      },
+        {7,       NO_EDGE, NO_EDGE}
+        // clang-format on
+    };
+    g.loadGraph(graph);
+
+    CHECK(g.neighbors(0) == vector<pair<size_t, int>>{{1, 4}, {2, -2}});
+    CHECK(g.neighbors(1) == vector<pair<size_t, int>>{{2, 3}});
+    CHECK(g.inNeighbors(2) == vector<pair<size_t, int>>{{0, -2}, {1, 3}});
+    CHECK(g.inNeighbors(1) == vector<pair<size_t, int>>{{0, 4}});
+    CHECK(g.getMaxEdgeWeight() == 7);
+
+    // the lists follow the changes of the graph
+    g *= 2;
+    CHECK(g.getMaxEdgeWeight() == 14);
+    CHECK(g.neighbors(2) == vector<pair<size_t, int>>{{0, 14}});
+    CHECK(g.inNeighbors(0) == vector<pair<size_t, int>>{{2, 14}});
+    g /= 4;
+    CHECK(g.neighbors(0) == vector<pair<size_t, int>>{{1, 2}, {2, -1}});
+    ++g;
+    CHECK(g.neighbors(0) == vector<pair<size_t, int>>{{1, 3}});  // -1 + 1 = 0, the edge (0, 2) is removed
+    CHECK(g.inNeighbors(2) == vector<pair<size_t, int>>{{1, 2}});
+}
+
+TEST_CASE("Test reorder") {
+    Graph g;
+    // the path 0-3-1-4-2, with "random" ids
+    vector<vector<int>> graph = {
+        // clang-format off
+        {NO_EDGE, NO_EDGE, NO_EDGE, 1,       NO_EDGE},
+        {NO_EDGE, NO_EDGE, NO_EDGE, 2,       3      },
+        {NO_EDGE, NO_EDGE, NO_EDGE, NO_EDGE, 4      },
+        {1,       2,       NO_EDGE, NO_EDGE, NO_EDGE},
+        {NO_EDGE, 3,       4,       NO_EDGE, NO_EDGE}
+        // clang-format on
+    };
+    g.loadGraph(graph);
+    CHECK(g.isReordered() == false);
+    CHECK(g.toOriginalId(3) == 3);
+
+    for (VertexOrder order : {VertexOrder::RCM, VertexOrder::DEGREE, VertexOrder::BFS, VertexOrder::COMMUNITY}) {
+        Graph h = g;
+        h.reorder(order);
+        CHECK(h.getNumEdges() == g.getNumEdges());
+        for (size_t v = 0; v < 5; v++) {
+            CHECK(h.toInternalId(h.toOriginalId(v)) == v);
+            for (auto [u, w] : h.neighbors(v)) {  // every edge keeps its weight
+                CHECK(graph[h.toOriginalId(v)][h.toOriginalId(u)] == w);
+            }
+        }
+        CHECK(h == g);
+    }
+
+    // RCM and BFS store the path with consecutive ids (bandwidth 1)
+    for (VertexOrder order : {VertexOrder::RCM, VertexOrder::BFS}) {
+        Graph h = g;
+        h.reorder(order);
+        CHECK(h.isReordered() == true);
+        for (size_t v = 0; v < 5; v++) {
+            for (auto [u, w] : h.neighbors(v)) {
+                CHECK((u == v + 1 || v == u + 1));
+            }
+        }
+    }
+
+    Graph h = g;
+    h.reorder(VertexOrder::RCM);
+
+    // the printing and the serialization use the original ids
+    stringstream gOut, hOut;
+    g.printAdjMat(gOut);
+    h.printAdjMat(hOut);
+    CHECK(gOut.str() == hOut.str());
+
+    stringstream data;
+    GraphSerializer::write(h, data);
+    CHECK(GraphSerializer::read(data).getGraph() == graph);
+
+    // the operators match the vertices by the original ids
+    Graph sum = g + h;
+    sum.reorder(VertexOrder::ORIGINAL);
+    CHECK(sum == g * 2);
+    CHECK((g < h) == false);
+    CHECK((h < g) == false);
+
+    // restore the original order
+    h.reorder(VertexOrder::ORIGINAL);
+    CHECK(h.isReordered() == false);
+    CHECK(h.getGraph() == graph);
+
+    // loading a new graph clears the order
+    h.reorder(VertexOrder::DEGREE);
+    h.loadGraph(graph);
+    CHECK(h.isReordered() == false);
+}
+
 TEST_CASE("Test printGraph") {
     // Redirect std::cout to a buffer
     std::stringstream buffer;
@@ -140,7 +245,7 @@ TEST_CASE("Test printGraph") {
 /**
  * helper function to check if the adjacency matrixes are equal
  */
-bool checkMatrixes(const vector<vector<int>>& m1, const vector<vector<int>>& m2, vector<vector<int>>& expected, const function<int(int, int)>& op) {
+bool checkMatrixes(const vector<vector<int>>& m1, const vector<vector<int>>& m2, const vector<vector<int>>& expected, const function<int(int, int)>& op) {
     for (size_t i = 0; i < m1.size(); i++) {
         for (size_t j = 0; j < m1.size(); j++) {
             if (m1[i][j] == NO_EDGE && m2[i][j] == NO_EDGE) {  // if they are both NO_EDGE - the expected value should be NO_EDGE
@@ -1488,4 +1593,236 @@ TEST_CASE("<<") {
 
         CHECK(ss.str() == expected);
     }
-}
\ No newline at end of file
+}
+TEST_CASE("GraphSerializer") {
+    vector<vector<int>> graph = {
+        // clang-format off
+        {NO_EDGE, 3,       NO_EDGE, -7     },
+        {NO_EDGE, NO_EDGE, 1000,    NO_EDGE},
+        {1,       NO_EDGE, NO_EDGE, NO_EDGE},
+        {NO_EDGE, NO_EDGE, 2,       NO_EDGE}
+        // clang-format on
+    };
+    Graph g;
+    g.loadGraph(graph);
+
+    SUBCASE("round trip") {
+        for (GraphSerializer::Codec codec : {GraphSerializer::Codec::NONE, GraphSerializer::Codec::LZ}) {
+            stringstream ss;
+            GraphSerializer::write(g, ss, codec, 3);
+            Graph g2 = GraphSerializer::read(ss);
+            CHECK(g2.getGraph() == graph);
+            CHECK(g2.isDirectedGraph() == true);
+            CHECK(g2.isHaveNegativeEdgeWeight() == true);
+            CHECK(g2.getNumEdges() == 5);
+        }
+
+        // empty graph
+        Graph empty;
+        empty.loadGraph({});
+        stringstream ss;
+        GraphSerializer::write(empty, ss);
+        CHECK(GraphSerializer::read(ss).getNumVertices() == 0);
+    }
+
+    SUBCASE("partial load") {
+        stringstream ss;
+        GraphSerializer::write(g, ss, GraphSerializer::Codec::LZ, 2);
+        GraphSerializer::Header header = GraphSerializer::readHeader(ss);
+        CHECK(header.numVertices == 4);
+        CHECK(header.isDirected == true);
+        CHECK(header.blocks.size() == 2);
+
+        // decode only the second block
+        vector<vector<int>> rows = GraphSerializer::readBlock(ss, header, 1);
+        CHECK(rows.size() == 2);
+        CHECK(rows[0] == graph[2]);
+        CHECK(rows[1] == graph[3]);
+        CHECK_THROWS_AS(GraphSerializer::readBlock(ss, header, 2), std::out_of_range);
+    }
+
+    SUBCASE("mostly empty graph compresses") {
+        size_t n = 500;
+        vector<vector<int>> sparse(n, vector<int>(n, NO_EDGE));
+        for (size_t i = 0; i + 1 < n; i += 50) {
+            sparse[i][i + 1] = 1;
+            sparse[i + 1][i] = 1;
+        }
+        Graph g2;
+        g2.loadGraph(sparse);
+
+        stringstream ss;
+        GraphSerializer::write(g2, ss);
+        CHECK(ss.str().size() * 100 < n * n * sizeof(int));
+        CHECK(GraphSerializer::read(ss).getGraph() == sparse);
+    }
+
+    SUBCASE("codec") {
+        vector<uint8_t> data;
+        for (size_t i = 0; i < 1000; i++) {
+            data.push_back(static_cast<uint8_t>(i % 7 == 0 ? i : 0));
+        }
+        vector<uint8_t> compressed = GraphSerializer::compress(data);
+        CHECK(compressed.size() < data.size());
+        CHECK(GraphSerializer::decompress(compressed, data.size()) == data);
+        CHECK(GraphSerializer::decompress(GraphSerializer::compress({}), 0).empty());
+        CHECK_THROWS_AS(GraphSerializer::decompress(compressed, data.size() + 1), std::runtime_error);
+    }
+
+    SUBCASE("errors") {
+        stringstream ss("not a graph");
+        CHECK_THROWS_AS(GraphSerializer::read(ss), std::runtime_error);
+        stringstream ss2;
+        CHECK_THROWS_AS(GraphSerializer::write(g, ss2, GraphSerializer::Codec::LZ, 0), std::invalid_argument);
+
+        // a header with the given sizes: "SGG", version, flags, |V|, |E|, rowsPerBlock, number of blocks and the block directory
+        auto varint = [](uint64_t value) {
+            string bytes;
+            for (; value >= 0x80; value >>= 7) {
+                bytes += static_cast<char>(value | 0x80);
+            }
+            return bytes + static_cast<char>(value);
+        };
+        auto corrupted = [&varint](uint64_t numVertices, uint64_t rowsPerBlock, uint64_t numBlocks, const string& rest) {
+            return "SGG" + string(1, '\x01') + string(1, '\x01') + varint(numVertices) + varint(0) + varint(rowsPerBlock) + varint(numBlocks) + rest;
+        };
+        uint64_t huge = uint64_t(1) << 60;
+        for (const string& data : {
+                 corrupted(huge, 1, huge, ""),                                                   // more vertices than the data can hold
+                 corrupted(600, 1, 600, string(10, '\x00')),                                     // a truncated block directory
+                 corrupted(1, 1, 1, string(1, '\x00') + varint(huge) + varint(huge)),            // a row that is bigger than |V| edges
+                 corrupted(1000, 1000, 1, string(1, '\x01') + varint(100000) + varint(1) + "x"),  // a compressed block that expands too much
+                 corrupted(1, 1, 1, string(1, '\x01') + varint(1) + varint(huge)),               // a huge block that is not in the data
+                 corrupted(1, 1, 1, string(1, '\x00') + varint(5) + varint(5) + "x"),            // a truncated block
+             }) {
+            stringstream corrupt(data);
+            CHECK_THROWS_AS(GraphSerializer::read(corrupt), std::runtime_error);
+        }
+
+        // the gap of the second edge of row 0 is 2^64 - 1, that would wrap the column back to 0
+        string row = "\x02\x00\x02" + varint(~uint64_t(0)) + "\x02\x00";
+        GraphSerializer::BlockInfo block{GraphSerializer::Codec::NONE, 0, 2, row.size(), row.size(), 0};
+        CHECK_THROWS_AS(GraphSerializer::decodeBlock(vector<uint8_t>(row.begin(), row.end()), block, 2), std::runtime_error);
+        CHECK_THROWS_AS(GraphSerializer::decompress({0x10, 'x'}, size_t(1) << 40), std::runtime_error);
+    }
+}
+
+TEST_CASE("CsrBuilder and MappedCsrGraph") {
+    string path = "csr_graph_test.bin";
+
+    SUBCASE("edges spilled to runs") {
+        {
+            // at most 2 edges in memory, so the edges are merged from several runs
+            CsrBuilder builder(path, 4, true, 2);
+            builder.addEdge(3, 1, 5);
+            builder.addEdge(0, 2, -1);
+            builder.addEdge(0, 1);
+            builder.addEdge(2, 3, 7);
+            builder.addEdge(1, 0);
+            CHECK(builder.getNumRuns() == 2);
+            builder.finish();
+            CHECK(builder.getNumRuns() == 0);
+        }
+
+        MappedCsrGraph g(path);
+        CHECK(g.getNumVertices() == 4);
+        CHECK(g.getNumEdges() == 5);
+        CHECK(g.isDirectedGraph() == true);
+        CHECK(g.isWeightedGraph() == true);
+        CHECK(g.isHaveNegativeEdgeWeight() == true);
+
+        vector<pair<size_t, int>> neighbors;
+        for (auto [v, w] : g.neighbors(0)) {
+            neighbors.emplace_back(v, w);
+        }
+        CHECK(neighbors == vector<pair<size_t, int>>{{1, 1}, {2, -1}});
+        CHECK(g.neighbors(1).size() == 1);
+        CHECK(g.neighbors(3).size() == 1);
+    }
+
+    SUBCASE("undirected graph") {
+        {
+            CsrBuilder builder(path, 3, false);
+            builder.addEdge(0, 1);
+            builder.addEdge(1, 2);
+            builder.finish();
+        }
+        MappedCsrGraph g(path);
+        CHECK(g.getNumEdges() == 4);  // every edge is stored in both directions
+        CHECK(g.isDirectedGraph() == false);
+        CHECK(g.isWeightedGraph() == false);
+        CHECK(g.neighbors(1).size() == 2);
+    }
+
+    SUBCASE("errors") {
+        CsrBuilder builder(path, 3, true, 1);
+        CHECK_THROWS_AS(builder.addEdge(0, 3), std::invalid_argument);
+        CHECK_THROWS_AS(builder.addEdge(1, 1), std::invalid_argument);
+        CHECK_THROWS_AS(builder.addEdge(0, 1, NO_EDGE), std::invalid_argument);
+        builder.addEdge(0, 1);
+        builder.addEdge(0, 1, 2);
+        CHECK_THROWS_AS(builder.finish(), std::invalid_argument);  // duplicate edge
+        CHECK_THROWS_AS(builder.addEdge(1, 2), std::logic_error);
+        CHECK_THROWS_AS(MappedCsrGraph("no_such_file.bin"), std::runtime_error);
+    }
+
+    SUBCASE("corrupted files") {
+        {
+            CsrBuilder builder(path, 3);
+            builder.addEdge(0, 1);
+            builder.addEdge(1, 2);
+            builder.finish();
+        }
+        std::ifstream in(path, std::ios::binary);
+        string valid((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        in.close();
+        auto writeFile = [&path](const string& bytes) {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        };
+        // the header is 32 bytes (|V| at byte 8 and |E| at byte 16), then 4 offsets of 8 bytes and the 2 targets
+        auto setNumber = [](string& bytes, size_t pos, uint64_t value) { std::memcpy(&bytes[pos], &value, sizeof(value)); };
+
+        writeFile(valid.substr(0, valid.size() - 4));  // truncated
+        CHECK_THROWS_AS(MappedCsrGraph{path}, std::runtime_error);
+
+        string badTarget = valid;
+        badTarget[32 + 4 * 8] = 7;  // the target of the first edge is not a vertex
+        writeFile(badTarget);
+        CHECK_THROWS_AS(MappedCsrGraph{path}, std::runtime_error);
+
+        // (|V| + 1) * 8 wraps around to 0, and |E| is set so the total size matches the size of the file
+        string wrapped = valid;
+        setNumber(wrapped, 8, (uint64_t(1) << 61) - 1);
+        setNumber(wrapped, 16, 2 + 4);
+        writeFile(wrapped);
+        CHECK_THROWS_AS(MappedCsrGraph{path}, std::runtime_error);
+
+        writeFile(valid);
+        CHECK(MappedCsrGraph(path).getNumEdges() == 2);
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("getRevision") {
+    Graph g1;
+    CHECK(g1.getRevision() == 0);  // not loaded yet
+    CHECK(g1.getMaxEdgeWeight() == 0);
+    g1.loadGraph({{0, 1}, {1, 0}});
+    CHECK(g1.getRevision() != 0);
+    Graph g2 = g1;
+    CHECK(g1.getRevision() == g2.getRevision());
+
+    uint64_t revision = g1.getRevision();
+    g1 += g2;
+    CHECK(g1.getRevision() != revision);
+    CHECK(g2.getRevision() == revision);
+
+    revision = g1.getRevision();
+    g1.reorder(VertexOrder::RCM);
+    CHECK(g1.getRevision() != revision);
+
+    g2.loadGraph({{0, 1}, {1, 0}});
+    CHECK(g2.getRevision() != revision);
+}
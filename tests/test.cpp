@@ -2,6 +2,7 @@
  * @author Shay Gali
  * @link shay.gali@msmail.ariel.ac.il
  */
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
 #include <sstream>
@@ -9,6 +10,10 @@
 #include <vector>
 
 #include "../algorithms/Algorithms.hpp"
+#include "../algorithms/ContractionHierarchy.hpp"
+#include "../algorithms/DistanceCache.hpp"
+#include "../algorithms/LandmarkIndex.hpp"
+#include "../algorithms/ThreadPool.hpp"
 #include "../graph/Graph.hpp"
 #include "doctest.h"
 
@@ -109,6 +114,49 @@ TEST_CASE("Test isConnected for undirected graph") {
     CHECK(Algorithms::isConnected(g) == true);
 }
 
+TEST_CASE("Test isStronglyConnected") {
+    Graph g;
+
+    vector<vector<int>> emptyGraph = {};
+    g.loadGraph(emptyGraph);
+    CHECK(Algorithms::isStronglyConnected(g) == true);
+
+    // 0-->1-->2-->0
+    vector<vector<int>> graph = {
+        // clang-format off
+        {NO_EDGE, 1,       NO_EDGE},
+        {NO_EDGE, NO_EDGE, 1      },
+        {1,       NO_EDGE, NO_EDGE}
+        // clang-format on
+    };
+    g.loadGraph(graph);
+    CHECK(Algorithms::isStronglyConnected(g) == true);
+
+    // 3 reaches all the vertices, but no vertex reaches 3
+    vector<vector<int>> graph2 = {
+        // clang-format off
+        {NO_EDGE, 1,       NO_EDGE, NO_EDGE},
+        {NO_EDGE, NO_EDGE, 1,       NO_EDGE},
+        {1,       NO_EDGE, NO_EDGE, NO_EDGE},
+        {NO_EDGE, 1,       NO_EDGE, NO_EDGE}
+        // clang-format on
+    };
+    g.loadGraph(graph2);
+    CHECK(Algorithms::isConnected(g) == true);
+    CHECK(Algorithms::isStronglyConnected(g) == false);
+
+    // 0---1---2
+    vector<vector<int>> graph3 = {
+        // clang-format off
+        {NO_EDGE, 1,       NO_EDGE},
+        {1,       NO_EDGE, 1      },
+        {NO_EDGE, 1,       NO_EDGE}
+        // clang-format on
+    };
+    g.loadGraph(graph3);
+    CHECK(Algorithms::isStronglyConnected(g) == true);
+}
+
 TEST_CASE("Error check shortestPath") {
     Graph g;
     vector<vector<int>> graph = {
@@ -296,6 +344,750 @@ TEST_CASE("Test shortestPath for directed graph weighted with negative weights")
     CHECK(Algorithms::shortestPath(g, 0, 1) == "Graph contains a negative-weight cycle");
 
     // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // a long chain of negative edges (the queue-based Bellman-Ford scans every vertex once), and a negative cycle at its end
+    size_t n = 50;
+    vector<vector<int>> graph5(n, vector<int>(n, NO_EDGE));
+    for (size_t u = 0; u + 1 < n; u++) {
+        graph5[u][u + 1] = -2;
+    }
+    for (size_t v = 2; v < n; v++) {
+        graph5[0][v] = 1;
+    }
+    g.loadGraph(graph5);
+    CHECK(Algorithms::findShortestPath(g, 0, n - 1).distance == -2 * (int)(n - 1));
+    CHECK(Algorithms::findShortestPath(g, 0, n - 1).path.size() == n);
+
+    graph5[n - 1][n - 3] = 3;  // n-3 -> n-2 -> n-1 -> n-3 = -1
+    g.loadGraph(graph5);
+    CHECK(Algorithms::shortestPath(g, 0, 1) == "Graph contains a negative-weight cycle");
+    CHECK(Algorithms::shortestPath(g, n - 1, n - 2) == "Graph contains a negative-weight cycle");
+}
+
+TEST_CASE("Test parallel Bellman-Ford") {
+    // the pool runs every task once, and passes the exceptions to the caller
+    ThreadPool pool(4);
+    vector<int> counts(100, 0);
+    pool.run(counts.size(), [&counts](size_t i) { counts[i]++; });
+    CHECK(std::count(counts.begin(), counts.end(), 1) == 100);
+    CHECK_THROWS_AS(pool.run(10, [](size_t i) { if (i == 7) { throw std::runtime_error("task failed"); } }), std::runtime_error);
+
+    // a task can run a job on its own pool (the nested job runs on the thread of the task)
+    vector<int> nested(100, 0);
+    pool.run(10, [&pool, &nested](size_t i) { pool.run(10, [&nested, i](size_t j) { nested[i * 10 + j]++; }); });
+    CHECK(std::count(nested.begin(), nested.end(), 1) == 100);
+    CHECK_THROWS_AS(pool.run(4, [&pool](size_t) { pool.run(4, [](size_t j) { if (j == 2) { throw std::runtime_error("task failed"); } }); }),
+                    std::runtime_error);
+    pool.run(counts.size(), [&counts](size_t i) { counts[i]++; });  // the pool still works after the nested jobs
+    CHECK(std::count(counts.begin(), counts.end(), 2) == 100);
+
+    // a directed graph with negative weights: the parallel rounds find the same distances as the sequential search
+    size_t n = 40;
+    vector<vector<int>> graph(n, vector<int>(n, NO_EDGE));
+    for (size_t u = 0; u < n; u++) {
+        graph[u][(u + 1) % n] = 5;
+        graph[u][(u * 7 + 3) % n] = (int)(u % 5) - 1;
+    }
+    for (size_t u = 0; u < n; u++) {
+        graph[u][u] = NO_EDGE;
+    }
+    Graph g;
+    g.loadGraph(graph);
+    for (size_t src = 0; src < n; src += 7) {
+        for (size_t dest = 0; dest < n; dest++) {
+            Algorithms::ShortestPathResult expected = Algorithms::findShortestPath(g, src, dest);
+            Algorithms::ShortestPathResult result = Algorithms::findShortestPath(g, src, dest, QueuePolicy::AUTO, ExecutionPolicy::PARALLEL);
+            CHECK(result.status == expected.status);
+            CHECK(result.distance == expected.distance);
+        }
+    }
+
+    // the negative cycle of graph3 in "Test shortestPath for directed graph weighted with negative weights"
+    g.loadGraph({{NO_EDGE, -1, NO_EDGE}, {NO_EDGE, NO_EDGE, -1}, {1, NO_EDGE, NO_EDGE}});
+    CHECK(Algorithms::shortestPath(g, 0, 1, ExecutionPolicy::PARALLEL) == "Graph contains a negative-weight cycle");
+    CHECK(Algorithms::shortestPathTree(g, 2, QueuePolicy::AUTO, ExecutionPolicy::PARALLEL).hasNegativeCycle());
+}
+
+TEST_CASE("Test delta-stepping") {
+    // a 20x20 undirected grid with weights 1-3 (many shortest paths with the same length) and a few long edges
+    size_t side = 20;
+    size_t n = side * side;
+    vector<vector<int>> graph(n, vector<int>(n, NO_EDGE));
+    for (size_t u = 0; u < n; u++) {
+        if (u % side < side - 1) {
+            graph[u][u + 1] = graph[u + 1][u] = (int)(u % 3) + 1;
+        }
+        if (u + side < n) {
+            graph[u][u + side] = graph[u + side][u] = (int)(u % 2) + 1;
+        }
+    }
+    graph[0][n - 1] = graph[n - 1][0] = 30;
+    graph[side][n / 2] = graph[n / 2][side] = 1000;
+    Graph g;
+    g.loadGraph(graph);
+
+    // the same distances and the same paths as the sequential Dijkstra
+    for (size_t src : vector<size_t>{0, 57, n - 1}) {
+        Algorithms::ShortestPathTree expected = Algorithms::shortestPathTree(g, src);
+        Algorithms::ShortestPathTree tree = Algorithms::shortestPathTree(g, src, QueuePolicy::AUTO, ExecutionPolicy::PARALLEL);
+        for (size_t v = 0; v < n; v++) {
+            CHECK(tree.distanceTo(v) == expected.distanceTo(v));
+            CHECK(tree.pathTo(v) == expected.pathTo(v));
+        }
+    }
+    CHECK(Algorithms::shortestPath(g, 5, 333, ExecutionPolicy::PARALLEL) == Algorithms::shortestPath(g, 5, 333));
+
+    // no path
+    g.loadGraph({{NO_EDGE, 2, NO_EDGE}, {NO_EDGE, NO_EDGE, NO_EDGE}, {NO_EDGE, 2, NO_EDGE}});
+    CHECK(Algorithms::shortestPath(g, 0, 2, ExecutionPolicy::PARALLEL) == "-1");
+    CHECK(Algorithms::shortestPath(g, 2, 1, ExecutionPolicy::PARALLEL) == "2->1");
+}
+
+TEST_CASE("Test johnson") {
+    // a directed graph with negative weights (and a 0-weight cycle 1->2->1), and a vertex that can't be reached
+    Graph g;
+    vector<vector<int>> graph = {
+        // clang-format off
+                // 0      1        2        3        4        5
+        /* 0 */{NO_EDGE, 4,       NO_EDGE, 5,       NO_EDGE, NO_EDGE},
+        /* 1 */{NO_EDGE, NO_EDGE, -2,      NO_EDGE, 6,       NO_EDGE},
+        /* 2 */{NO_EDGE, 2,       NO_EDGE, 3,       NO_EDGE, NO_EDGE},
+        /* 3 */{NO_EDGE, NO_EDGE, NO_EDGE, NO_EDGE, -1,      NO_EDGE},
+        /* 4 */{7,       NO_EDGE, NO_EDGE, NO_EDGE, NO_EDGE, NO_EDGE},
+        /* 5 */{NO_EDGE, NO_EDGE, NO_EDGE, 1,       NO_EDGE, NO_EDGE}
+        // clang-format on
+    };
+    g.loadGraph(graph);
+
+    // the same distances as a single-source search from every vertex, and the paths have these distances
+    auto checkAllPairs = [](const Graph& g, const Algorithms::AllPairsResult& result) {
+        size_t n = g.getNumVertices();
+        CHECK(result.getNumVertices() == n);
+        CHECK(result.hasNextHops());
+        for (size_t u = 0; u < n; u++) {
+            Algorithms::ShortestPathTree tree = Algorithms::shortestPathTree(g, u);
+            for (size_t v = 0; v < n; v++) {
+                CHECK(result.distance(u, v) == tree.distanceTo(v));
+                CHECK(result.getDistances()[u * n + v] == tree.distanceTo(v));
+
+                vector<size_t> path = result.path(u, v);
+                if (tree.distanceTo(v) == INF) {
+                    CHECK(path.empty());
+                    continue;
+                }
+                REQUIRE(!path.empty());
+                CHECK(path.front() == u);
+                CHECK(path.back() == v);
+                int length = 0;
+                for (size_t i = 1; i < path.size(); i++) {  // the matrix of the graph is indexed by the internal ids
+                    int w = g.getGraph()[g.toInternalId(path[i - 1])][g.toInternalId(path[i])];
+                    REQUIRE(w != NO_EDGE);
+                    length += w;
+                }
+                CHECK(length == tree.distanceTo(v));
+            }
+        }
+    };
+    checkAllPairs(g, Algorithms::johnson(g, true));
+    checkAllPairs(g, Algorithms::johnson(g, true, ExecutionPolicy::SEQUENTIAL));
+
+    Algorithms::AllPairsResult result = Algorithms::johnson(g, true);
+    CHECK(result.distance(0, 4) == 4);
+    CHECK(result.path(0, 2) == vector<size_t>{0, 1, 2});
+    CHECK(result.nextHop(0, 2) == 1);
+    CHECK(result.nextHop(3, 3) == -1);
+    CHECK(result.distance(0, 5) == INF);
+    CHECK(result.nextHop(0, 5) == -1);
+    CHECK(result.path(5, 5) == vector<size_t>{5});
+    CHECK_THROWS_AS(result.distance(0, 6), std::out_of_range);
+
+    // without the next hops, only the distances
+    result = Algorithms::johnson(g);
+    CHECK_FALSE(result.hasNextHops());
+    CHECK(result.distance(2, 0) == 9);
+    CHECK_THROWS_AS(result.path(0, 4), std::logic_error);
+
+    // the ids stay the original ids after a reorder
+    g.reorder(VertexOrder::DEGREE);
+    checkAllPairs(g, Algorithms::johnson(g, true));
+
+    // an undirected grid with positive weights
+    size_t side = 8;
+    vector<vector<int>> grid(side * side, vector<int>(side * side, NO_EDGE));
+    for (size_t u = 0; u < side * side; u++) {
+        if (u % side < side - 1) {
+            grid[u][u + 1] = grid[u + 1][u] = (int)(u % 4) + 1;
+        }
+        if (u + side < side * side) {
+            grid[u][u + side] = grid[u + side][u] = (int)(u % 3) + 1;
+        }
+    }
+    g.loadGraph(grid);
+    checkAllPairs(g, Algorithms::johnson(g, true));
+
+    // a negative cycle: 1->2->3->1
+    graph[3][1] = -2;
+    g.loadGraph(graph);
+    result = Algorithms::johnson(g, true);
+    CHECK(result.hasNegativeCycle());
+    CHECK_FALSE(result.hasNextHops());
+    CHECK_THROWS_AS(result.distance(0, 1), std::runtime_error);
+
+    // an undirected negative edge is a negative cycle by itself, the potentials are not defined
+    g.loadGraph({{NO_EDGE, -1}, {-1, NO_EDGE}});
+    CHECK_THROWS_AS(Algorithms::johnson(g), std::invalid_argument);
+
+    g.loadGraph(vector<vector<int>>{});
+    CHECK(Algorithms::johnson(g).getDistances().empty());
+}
+
+TEST_CASE("Test floydWarshall") {
+    // a directed graph with 150 vertices (3 tiles in a row, the last one padded) and negative weights but no negative cycle:
+    // w(u, v) = base + p(u) - p(v) with base > 0, so the weight of every cycle is positive
+    size_t n = 150;
+    vector<int> p(n);
+    for (size_t v = 0; v < n; v++) {
+        p[v] = (int)(v * 7 % 11);
+    }
+    vector<vector<int>> graph(n, vector<int>(n, NO_EDGE));
+    for (size_t u = 0; u < n; u++) {
+        for (size_t v = 0; v < n; v++) {
+            if (u != v && (u * 31 + v * 17) % 13 == 0) {
+                int w = (int)((u + v) % 5) + 1 + p[u] - p[v];
+                graph[u][v] = w == NO_EDGE ? 1 : w;
+            }
+        }
+    }
+    Graph g;
+    g.loadGraph(graph);
+    REQUIRE(g.isHaveNegativeEdgeWeight());
+
+    // the same distances as johnson, and the paths of the next hops have these distances
+    auto checkAllPairs = [](const Graph& g, const Algorithms::AllPairsResult& result) {
+        size_t n = g.getNumVertices();
+        Algorithms::AllPairsResult expected = Algorithms::johnson(g);
+        CHECK(result.getDistances() == expected.getDistances());
+        for (size_t u = 0; u < n; u++) {
+            for (size_t v = 0; v < n; v++) {
+                vector<size_t> path = result.path(u, v);
+                if (result.distance(u, v) == INF) {
+                    CHECK(path.empty());
+                    continue;
+                }
+                REQUIRE(!path.empty());
+                CHECK(path.front() == u);
+                CHECK(path.back() == v);
+                int length = 0;
+                for (size_t i = 1; i < path.size(); i++) {
+                    int w = g.getGraph()[g.toInternalId(path[i - 1])][g.toInternalId(path[i])];
+                    REQUIRE(w != NO_EDGE);
+                    length += w;
+                }
+                CHECK(length == result.distance(u, v));
+            }
+        }
+    };
+    checkAllPairs(g, Algorithms::floydWarshall(g, true));
+    checkAllPairs(g, Algorithms::floydWarshall(g, true, ExecutionPolicy::SEQUENTIAL));
+    CHECK(Algorithms::floydWarshall(g).getDistances() == Algorithms::johnson(g).getDistances());
+    CHECK_FALSE(Algorithms::floydWarshall(g).hasNextHops());
+
+    g.reorder(VertexOrder::RCM);
+    checkAllPairs(g, Algorithms::floydWarshall(g, true));
+
+    // a small graph (a single padded tile), with a vertex that can't be reached
+    g.loadGraph({{NO_EDGE, 3, 8, NO_EDGE}, {NO_EDGE, NO_EDGE, 4, NO_EDGE}, {2, NO_EDGE, NO_EDGE, NO_EDGE}, {NO_EDGE, NO_EDGE, 1, NO_EDGE}});
+    Algorithms::AllPairsResult result = Algorithms::floydWarshall(g, true);
+    CHECK(result.distance(0, 2) == 7);
+    CHECK(result.path(0, 2) == vector<size_t>{0, 1, 2});
+    CHECK(result.distance(3, 1) == 6);
+    CHECK(result.path(3, 1) == vector<size_t>{3, 2, 0, 1});
+    CHECK(result.distance(0, 3) == INF);
+    CHECK(result.path(0, 3).empty());
+
+    // a negative cycle in the last tile: 140->141->142->140
+    graph[140][141] = -5;
+    graph[141][142] = -5;
+    graph[142][140] = -5;
+    g.loadGraph(graph);
+    result = Algorithms::floydWarshall(g, true);
+    CHECK(result.hasNegativeCycle());
+    CHECK_THROWS_AS(result.distance(0, 1), std::runtime_error);
+    CHECK(Algorithms::johnson(g).hasNegativeCycle());
+
+    g.loadGraph({{NO_EDGE, -1}, {-1, NO_EDGE}});
+    CHECK_THROWS_AS(Algorithms::floydWarshall(g), std::invalid_argument);
+
+    g.loadGraph(vector<vector<int>>{});
+    CHECK(Algorithms::floydWarshall(g).getDistances().empty());
+}
+
+TEST_CASE("Test findShortestPaths") {
+    // a 12x12 grid, directed to the right and down, with negative weights on a few edges (no negative cycle: the grid is acyclic)
+    size_t side = 12;
+    size_t n = side * side;
+    vector<vector<int>> graph(n, vector<int>(n, NO_EDGE));
+    for (size_t u = 0; u < n; u++) {
+        if (u % side < side - 1) {
+            graph[u][u + 1] = u % 7 == 0 ? -2 : (int)(u % 5) + 1;
+        }
+        if (u + side < n) {
+            graph[u][u + side] = (int)(u % 3) + 1;
+        }
+    }
+    Graph g;
+    g.loadGraph(graph);
+
+    // many queries per source, in a mixed order, with duplicates, a vertex to itself and unreachable vertices
+    vector<std::pair<size_t, size_t>> queries;
+    for (size_t i = 0; i < 600; i++) {
+        queries.emplace_back(i * 37 % 20, i * 53 % n);
+    }
+    queries.emplace_back(5, 5);
+    queries.emplace_back(n - 1, 0);
+    queries.emplace_back(5, 100);
+
+    auto checkBatch = [&](const Graph& g) {
+        for (ExecutionPolicy execution : {ExecutionPolicy::PARALLEL, ExecutionPolicy::SEQUENTIAL}) {
+            vector<Algorithms::ShortestPathResult> results = Algorithms::findShortestPaths(g, queries, execution);
+            vector<string> paths = Algorithms::shortestPaths(g, queries, execution);
+            REQUIRE(results.size() == queries.size());
+            REQUIRE(paths.size() == queries.size());
+            for (size_t i = 0; i < queries.size(); i++) {
+                Algorithms::ShortestPathResult expected = Algorithms::findShortestPath(g, queries[i].first, queries[i].second);
+                CHECK(results[i].status == expected.status);
+                CHECK(results[i].distance == expected.distance);
+                CHECK(results[i].path == expected.path);
+                CHECK(paths[i] == Algorithms::shortestPath(g, queries[i].first, queries[i].second));
+            }
+        }
+    };
+    checkBatch(g);
+    CHECK(Algorithms::shortestPaths(g, {{5, 5}, {n - 1, 0}})[1] == "-1");
+
+    // positive weights (Dijkstra), and the original ids after a reorder
+    for (vector<int>& row : graph) {
+        for (int& w : row) {
+            w = std::abs(w);
+        }
+    }
+    g.loadGraph(graph);
+    REQUIRE_FALSE(g.isHaveNegativeEdgeWeight());
+    checkBatch(g);
+    g.reorder(VertexOrder::RCM);
+    checkBatch(g);
+
+    // a single source (the search runs in parallel itself)
+    vector<std::pair<size_t, size_t>> single = {{3, 140}, {3, 4}, {3, 3}};
+    vector<string> paths = Algorithms::shortestPaths(g, single);
+    for (size_t i = 0; i < single.size(); i++) {
+        CHECK(paths[i] == Algorithms::shortestPath(g, single[i].first, single[i].second));
+    }
+
+    // a negative cycle that only some of the sources reach: 0->1->0
+    g.loadGraph({{NO_EDGE, 1, NO_EDGE}, {-3, NO_EDGE, NO_EDGE}, {NO_EDGE, NO_EDGE, NO_EDGE}});
+    paths = Algorithms::shortestPaths(g, {{0, 1}, {2, 0}, {1, 1}, {1, 0}});
+    CHECK(paths == vector<string>{"Graph contains a negative-weight cycle", "-1", "1", "Graph contains a negative-weight cycle"});
+
+    CHECK_THROWS_AS(Algorithms::findShortestPaths(g, {{0, 1}, {0, 3}}), std::invalid_argument);
+    CHECK(Algorithms::findShortestPaths(g, {}).empty());
+
+    // undirected with a negative edge: findShortestPath also searches from the destination, so the batch runs it for every query
+    g.loadGraph({{NO_EDGE, 5, NO_EDGE, 6}, {5, NO_EDGE, 1, -3}, {NO_EDGE, 1, NO_EDGE, 3}, {6, -3, 3, NO_EDGE}});
+    queries.clear();
+    for (size_t src = 0; src < 4; src++) {
+        for (size_t dest = 0; dest < 4; dest++) {
+            queries.emplace_back(src, dest);
+        }
+    }
+    checkBatch(g);
+}
+
+TEST_CASE("Test multiSourceBfs") {
+    // an unweighted directed graph with 200 vertices: a cycle with chords, and a few vertices that nothing reaches
+    size_t n = 200;
+    vector<vector<int>> graph(n, vector<int>(n, NO_EDGE));
+    for (size_t u = 0; u < n - 5; u++) {
+        graph[u][(u + 1) % (n - 5)] = 1;
+        if (u % 9 == 0 && (u * 7 + 3) % (n - 5) != u) {
+            graph[u][(u * 7 + 3) % (n - 5)] = 1;
+        }
+    }
+    for (size_t u = n - 5; u < n; u++) {
+        graph[u][u % 17] = 1;
+    }
+    Graph g;
+    g.loadGraph(graph);
+
+    // 150 sources (3 batches, the last one not full), with a repeated source
+    vector<size_t> sources;
+    for (size_t i = 0; i < 150; i++) {
+        sources.push_back(i * 13 % n);
+    }
+    sources.push_back(sources[3]);
+
+    auto checkDistances = [&](const Graph& g) {
+        for (ExecutionPolicy execution : {ExecutionPolicy::PARALLEL, ExecutionPolicy::SEQUENTIAL}) {
+            vector<vector<int>> distances = Algorithms::multiSourceBfs(g, sources, execution);
+            REQUIRE(distances.size() == sources.size());
+            for (size_t i = 0; i < sources.size(); i++) {
+                Algorithms::ShortestPathTree tree = Algorithms::shortestPathTree(g, sources[i]);
+                for (size_t v = 0; v < g.getNumVertices(); v++) {
+                    CHECK(distances[i][v] == tree.distanceTo(v));
+                }
+            }
+        }
+    };
+    checkDistances(g);
+    g.reorder(VertexOrder::BFS);
+    checkDistances(g);
+
+    // undirected
+    for (size_t u = 0; u < n; u++) {
+        for (size_t v = 0; v < n; v++) {
+            if (graph[u][v] != NO_EDGE) {
+                graph[v][u] = 1;
+            }
+        }
+    }
+    g.loadGraph(graph);
+    REQUIRE_FALSE(g.isDirectedGraph());
+    checkDistances(g);
+
+    // the weights are ignored: the number of edges
+    g.loadGraph({{NO_EDGE, 5, 1, NO_EDGE}, {NO_EDGE, NO_EDGE, NO_EDGE, 2}, {NO_EDGE, 1, NO_EDGE, NO_EDGE}, {NO_EDGE, NO_EDGE, NO_EDGE, NO_EDGE}});
+    CHECK(Algorithms::multiSourceBfs(g, {0, 3}) == vector<vector<int>>{{0, 1, 1, 2}, {INF, INF, INF, 0}});
+
+    CHECK(Algorithms::multiSourceBfs(g, {}).empty());
+    CHECK_THROWS_AS(Algorithms::multiSourceBfs(g, {0, 4}), std::invalid_argument);
+}
+
+TEST_CASE("Test direction-optimizing BFS") {
+    // a low-diameter unweighted graph with more vertices than DIRECTION_OPTIMIZING_MIN_VERTICES, so the middle levels are bottom-up
+    size_t n = 4100;
+    vector<vector<int>> graph(n, vector<int>(n, NO_EDGE));
+    uint64_t seed = 12345;
+    auto random = [&seed](size_t bound) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        return (size_t)(seed >> 33) % bound;
+    };
+    for (size_t u = 0; u < n; u++) {
+        graph[u][(u + 1) % n] = 1;  // a cycle, so the directed graph is strongly connected
+        for (size_t k = 0; k < 4; k++) {
+            size_t v = random(n);
+            if (v != u) {
+                graph[u][v] = 1;
+            }
+        }
+    }
+    Graph g;
+    g.loadGraph(graph);
+    REQUIRE(g.isDirectedGraph());
+
+    // the distances of shortestPathTree (direction-optimizing) are the distances of multiSourceBfs (top-down), and the paths are valid
+    auto checkTrees = [](const Graph& g, const vector<size_t>& sources) {
+        vector<vector<int>> expected = Algorithms::multiSourceBfs(g, sources);
+        for (size_t i = 0; i < sources.size(); i++) {
+            Algorithms::ShortestPathTree tree = Algorithms::shortestPathTree(g, sources[i]);
+            for (size_t v = 0; v < g.getNumVertices(); v++) {
+                REQUIRE(tree.distanceTo(v) == expected[i][v]);
+                vector<size_t> path = tree.pathTo(v);
+                REQUIRE(path.size() == (expected[i][v] == INF ? 0 : (size_t)expected[i][v] + 1));
+                for (size_t j = 1; j < path.size(); j++) {
+                    REQUIRE(g.getGraph()[g.toInternalId(path[j - 1])][g.toInternalId(path[j])] != NO_EDGE);
+                }
+            }
+        }
+    };
+    checkTrees(g, {0, 17, n - 1});
+    CHECK(Algorithms::isConnected(g));
+    CHECK(Algorithms::shortestPath(g, 5, 5) == "5");
+
+    // only the last vertex reaches all the others
+    for (size_t u = 0; u < n; u++) {
+        graph[u][n - 1] = NO_EDGE;
+    }
+    g.loadGraph(graph);
+    checkTrees(g, {0, n - 1});
+    CHECK(Algorithms::isConnected(g));
+    g.reorder(VertexOrder::DEGREE);
+    checkTrees(g, {3, n - 1});
+    CHECK(Algorithms::isConnected(g));
+
+    // no vertex reaches all the others
+    for (size_t v = 0; v < n; v++) {
+        graph[n - 1][v] = NO_EDGE;
+    }
+    g.loadGraph(graph);
+    CHECK_FALSE(Algorithms::isConnected(g));
+
+    // undirected and bipartite: the edges are between the even and the odd vertices
+    for (vector<int>& row : graph) {
+        std::fill(row.begin(), row.end(), NO_EDGE);
+    }
+    for (size_t u = 0; u < n; u += 2) {
+        for (size_t k = 0; k < 3; k++) {
+            size_t v = (random(n / 2) * 2 + 1) % n;
+            graph[u][v] = graph[v][u] = 1;
+        }
+        graph[u][u + 1] = graph[u + 1][u] = 1;
+        graph[u + 1][(u + 2) % n] = graph[(u + 2) % n][u + 1] = 1;
+    }
+    g.loadGraph(graph);
+    REQUIRE_FALSE(g.isDirectedGraph());
+    checkTrees(g, {0, 1001});
+    CHECK(Algorithms::isConnected(g));
+    string bipartite = Algorithms::isBipartite(g);
+    REQUIRE(bipartite.rfind("The graph is bipartite: A={0,", 0) == 0);
+    size_t split = bipartite.find("}, B={");
+    REQUIRE(split != string::npos);
+    auto checkSet = [n](const string& set, size_t parity) {  // the vertices of the set, comma separated, all with the given parity
+        size_t count = 0;
+        for (size_t pos = 0; pos < set.size(); pos = set.find(',', pos) + 1) {
+            CHECK(std::stoul(set.substr(pos)) % 2 == parity);
+            count++;
+            if (set.find(',', pos) == string::npos) {
+                break;
+            }
+        }
+        CHECK(count == n / 2);
+    };
+    checkSet(bipartite.substr(27, split - 27), 0);
+    checkSet(bipartite.substr(split + 6, bipartite.size() - split - 7), 1);
+
+    graph[0][2] = graph[2][0] = 1;
+    g.loadGraph(graph);
+    CHECK(Algorithms::isBipartite(g) == "The graph is not bipartite");
+
+    // a vertex with no edges
+    for (size_t v = 0; v < n; v++) {
+        graph[7][v] = graph[v][7] = NO_EDGE;
+    }
+    g.loadGraph(graph);
+    CHECK_FALSE(Algorithms::isConnected(g));
+}
+
+TEST_CASE("Test parallel BFS") {
+    Graph g;
+    vector<vector<int>> graph = {
+        {0, 1, 0, 0, 0},
+        {0, 0, 1, 0, 0},
+        {0, 0, 0, 1, 1},
+        {0, 0, 0, 0, 1},
+        {0, 0, 0, 0, 0}};
+    g.loadGraph(graph);
+    CHECK(Algorithms::shortestPath(g, 0, 4, ExecutionPolicy::PARALLEL) == "0->1->2->4");
+    CHECK(Algorithms::shortestPath(g, 4, 0, ExecutionPolicy::PARALLEL) == "-1");
+    CHECK(Algorithms::shortestPathTree(g, 1, QueuePolicy::AUTO, ExecutionPolicy::PARALLEL).pathTo(3) == vector<size_t>{1, 2, 3});
+
+    // a graph with more vertices than DIRECTION_OPTIMIZING_MIN_VERTICES, so some of the parallel levels are bottom-up
+    size_t n = 4100;
+    graph.assign(n, vector<int>(n, NO_EDGE));
+    uint64_t seed = 777;
+    auto random = [&seed](size_t bound) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        return (size_t)(seed >> 33) % bound;
+    };
+    for (size_t u = 0; u < n; u++) {
+        for (size_t k = 0; k < 5; k++) {
+            size_t v = random(n);
+            if (v != u) {
+                graph[u][v] = 1;
+            }
+        }
+    }
+    for (bool directed : {true, false}) {
+        if (!directed) {
+            for (size_t u = 0; u < n; u++) {
+                for (size_t v = 0; v < u; v++) {
+                    graph[u][v] = graph[v][u] = std::max(graph[u][v], graph[v][u]);
+                }
+            }
+        }
+        g.loadGraph(graph);
+        REQUIRE(g.isDirectedGraph() == directed);
+        vector<size_t> sources = {0, 99, n - 1};
+        vector<vector<int>> expected = Algorithms::multiSourceBfs(g, sources, ExecutionPolicy::SEQUENTIAL);
+        for (size_t i = 0; i < sources.size(); i++) {
+            Algorithms::ShortestPathTree tree = Algorithms::shortestPathTree(g, sources[i], QueuePolicy::AUTO, ExecutionPolicy::PARALLEL);
+            for (size_t v = 0; v < n; v++) {
+                REQUIRE(tree.distanceTo(v) == expected[i][v]);
+                vector<size_t> path = tree.pathTo(v);
+                REQUIRE(path.size() == (expected[i][v] == INF ? 0 : (size_t)expected[i][v] + 1));
+                for (size_t j = 1; j < path.size(); j++) {
+                    REQUIRE(graph[path[j - 1]][path[j]] != NO_EDGE);
+                }
+            }
+            Algorithms::ShortestPathResult result = Algorithms::findShortestPath(g, sources[i], 5, QueuePolicy::AUTO, ExecutionPolicy::PARALLEL);
+            CHECK(result.distance == expected[i][5]);
+        }
+    }
+
+    // memory-mapped graphs with more than PARALLEL_BFS_MIN_VERTICES vertices: a ring and a chord from every vertex,
+    // so the distances from 0 are the same as a BFS over the edges
+    string path = "csr_parallel_bfs_test.bin";
+    n = 20000;
+    auto chord = [n](size_t u) { return (u * 7919 + 13) % n; };
+    for (bool directed : {true, false}) {
+        {
+            CsrBuilder builder(path, n, directed);
+            for (size_t u = 0; u < n; u++) {
+                builder.addEdge(u, (u + 1) % n);
+                if (chord(u) != u && chord(u) != (u + 1) % n && (directed || (chord(chord(u)) != u && (chord(u) + 1) % n != u))) {
+                    builder.addEdge(u, chord(u));
+                }
+            }
+            builder.finish();
+        }
+        MappedCsrGraph mapped(path);
+        CHECK(Algorithms::isConnected(mapped));
+
+        vector<int> distances(n, INF);
+        vector<size_t> queue = {0};
+        distances[0] = 0;
+        for (size_t i = 0; i < queue.size(); i++) {
+            for (auto [v, w] : mapped.neighbors(queue[i])) {
+                if (distances[v] == INF) {
+                    distances[v] = distances[queue[i]] + 1;
+                    queue.push_back(v);
+                }
+            }
+        }
+        for (size_t dest : {size_t(1), size_t(n / 2), n - 1}) {
+            Algorithms::ShortestPathResult result = Algorithms::findShortestPath(mapped, 0, dest);
+            CHECK(result.distance == distances[dest]);
+            CHECK(result.path.size() == (size_t)distances[dest] + 1);
+        }
+    }
+
+    // a directed path 1-->2-->...-->n-1-->0: the search from 0 doesn't cover the graph, but 1 reaches all the vertices
+    {
+        CsrBuilder builder(path, n);
+        for (size_t u = 1; u < n; u++) {
+            builder.addEdge(u, (u + 1) % n);
+        }
+        builder.finish();
+    }
+    {
+        MappedCsrGraph mapped(path);
+        CHECK(Algorithms::isConnected(mapped));
+        CHECK(Algorithms::findShortestPath(mapped, 1, 0).distance == (int)n - 1);
+        CHECK(Algorithms::shortestPath(mapped, 0, 1) == "-1");
+    }
+
+    // two undirected halves
+    {
+        CsrBuilder builder(path, n, false);
+        for (size_t u = 0; u + 1 < n; u++) {
+            if (u + 1 != n / 2) {
+                builder.addEdge(u, u + 1);
+            }
+        }
+        builder.finish();
+    }
+    {
+        MappedCsrGraph mapped(path);
+        CHECK_FALSE(Algorithms::isConnected(mapped));
+        CHECK(Algorithms::findShortestPath(mapped, 0, n / 2 - 1).distance == (int)n / 2 - 1);
+        CHECK(Algorithms::shortestPath(mapped, 0, n / 2) == "-1");
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Test DistanceCache") {
+    Graph g;
+    vector<vector<int>> graph = {
+        // clang-format off
+                // 0      1        2        3        4
+        /* 0 */{NO_EDGE, 4,       2,       NO_EDGE, NO_EDGE},
+        /* 1 */{NO_EDGE, NO_EDGE, NO_EDGE, 2,       NO_EDGE},
+        /* 2 */{NO_EDGE, -1,      NO_EDGE, 6,       NO_EDGE},
+        /* 3 */{1,       NO_EDGE, NO_EDGE, NO_EDGE, NO_EDGE},
+        /* 4 */{NO_EDGE, NO_EDGE, NO_EDGE, 3,       NO_EDGE}
+        // clang-format on
+    };
+    g.loadGraph(graph);
+    DistanceCache cache(g);
+
+    // the same results as Algorithms::shortestPath, one search per source
+    for (size_t src = 0; src < 5; src++) {
+        for (size_t dest = 0; dest < 5; dest++) {
+            CHECK(cache.shortestPath(src, dest) == Algorithms::shortestPath(g, src, dest));
+        }
+    }
+    CHECK(cache.getNumTrees() == 5);
+    CHECK(cache.getStats().misses == 5);  // the queries from a vertex to itself don't need a tree
+    CHECK(cache.getStats().hits == 15);
+    CHECK(cache.distance(0, 3) == 3);
+    CHECK(cache.distance(0, 4) == INF);
+    CHECK(cache.findShortestPath(0, 3).path == vector<size_t>{0, 2, 1, 3});
+    CHECK_THROWS_AS(cache.shortestPath(0, 5), std::invalid_argument);
+    CHECK_THROWS_AS(cache.distance(5, 0), std::invalid_argument);
+
+    // any change of the graph drops the trees
+    g += g;
+    CHECK(cache.distance(0, 3) == 6);
+    CHECK(cache.getNumTrees() == 1);
+    CHECK(cache.getStats().invalidations == 1);
+    ++g;
+    CHECK(cache.shortestPath(0, 3) == Algorithms::shortestPath(g, 0, 3));
+    g.loadGraph(graph);
+    CHECK(cache.distance(0, 3) == 3);
+    g.reorder(VertexOrder::DEGREE);
+    CHECK(cache.shortestPath(4, 2) == Algorithms::shortestPath(g, 4, 2));
+    CHECK(cache.getStats().invalidations == 4);
+
+    // a negative cycle 0->2->1->3->0
+    graph[3][0] = -5;
+    g.loadGraph(graph);
+    CHECK(cache.findShortestPath(0, 1).status == Algorithms::ShortestPathResult::Status::NEGATIVE_CYCLE);
+    CHECK(cache.shortestPath(4, 1) == "Graph contains a negative-weight cycle");
+    CHECK_THROWS_AS(cache.distance(0, 1), std::runtime_error);
+    CHECK(cache.shortestPath(1, 1) == "1");
+
+    // a budget of 2 trees: the least recently used tree is evicted
+    g.loadGraph({{NO_EDGE, 1, 4, NO_EDGE}, {1, NO_EDGE, 2, 6}, {4, 2, NO_EDGE, 3}, {NO_EDGE, 6, 3, NO_EDGE}});
+    DistanceCache small(g, 2 * DistanceCache(g).getTreeBytes());
+    REQUIRE(small.getCapacity() == 2);
+    small.distance(0, 1);
+    small.distance(1, 0);
+    small.distance(0, 2);  // 0 is used last, so 1 is evicted next
+    small.distance(2, 0);
+    CHECK(small.getNumTrees() == 2);
+    CHECK(small.getStats().evictions == 1);
+    small.distance(0, 3);
+    CHECK(small.getStats().hits == 2);
+    small.distance(1, 3);
+    CHECK(small.getStats().misses == 4);
+    CHECK_THROWS_AS(small.precompute(), std::length_error);
+
+    // all the trees of a small graph at once
+    DistanceCache all(g);
+    all.precompute();
+    CHECK(all.getNumTrees() == g.getNumVertices());
+    for (size_t src = 0; src < g.getNumVertices(); src++) {
+        for (size_t dest = 0; dest < g.getNumVertices(); dest++) {
+            CHECK(all.shortestPath(src, dest) == Algorithms::shortestPath(g, src, dest));
+        }
+    }
+    CHECK(all.getStats().misses == g.getNumVertices());
+    all.clear();
+    CHECK(all.getNumTrees() == 0);
+
+    // undirected with a negative edge: no trees, every query runs findShortestPath
+    g.loadGraph({{NO_EDGE, 5, NO_EDGE, 6}, {5, NO_EDGE, 1, -3}, {NO_EDGE, 1, NO_EDGE, 3}, {6, -3, 3, NO_EDGE}});
+    all.precompute();
+    for (size_t src = 0; src < 4; src++) {
+        for (size_t dest = 0; dest < 4; dest++) {
+            Algorithms::ShortestPathResult expected = Algorithms::findShortestPath(g, src, dest);
+            Algorithms::ShortestPathResult result = all.findShortestPath(src, dest);
+            CHECK(result.status == expected.status);
+            CHECK(result.distance == expected.distance);
+            CHECK(result.path == expected.path);
+            CHECK(all.distance(src, dest) == expected.distance);
+        }
+    }
+    CHECK(all.getNumTrees() == 0);
 }
 
 TEST_CASE("Test shortestPath for undirected graph unweighted") {
@@ -509,6 +1301,453 @@ TEST_CASE("Test shortestPath for undirected graph weighted with negative weights
     g.loadGraph(graph2);
     CHECK(Algorithms::shortestPath(g, 12, 13) == "12->11->13");
 }
+TEST_CASE("Test findShortestPath") {
+    using Status = Algorithms::ShortestPathResult::Status;
+    Graph g;
+
+    // 0 -4-> 1 -1-> 2, 0 -7-> 2, 3 is not reachable
+    vector<vector<int>> graph = {
+        // clang-format off
+        {NO_EDGE, 4,       7,       NO_EDGE},
+        {NO_EDGE, NO_EDGE, 1,       NO_EDGE},
+        {NO_EDGE, NO_EDGE, NO_EDGE, NO_EDGE},
+        {NO_EDGE, NO_EDGE, 2,       NO_EDGE}
+        // clang-format on
+    };
+    g.loadGraph(graph);
+
+    Algorithms::ShortestPathResult result = Algorithms::findShortestPath(g, 0, 2);
+    CHECK(result.status == Status::FOUND);
+    CHECK(result.distance == 5);
+    CHECK(result.path == vector<size_t>{0, 1, 2});
+    CHECK(Algorithms::formatPath(result) == "0->1->2");
+
+    result = Algorithms::findShortestPath(g, 0, 3);
+    CHECK(result.status == Status::NO_PATH);
+    CHECK(result.distance == INF);
+    CHECK(result.path.empty());
+    CHECK(Algorithms::formatPath(result) == "-1");
+
+    result = Algorithms::findShortestPath(g, 1, 1);
+    CHECK(result.status == Status::FOUND);
+    CHECK(result.distance == 0);
+    CHECK(result.path == vector<size_t>{1});
+
+    CHECK_THROWS_AS(Algorithms::findShortestPath(g, 0, 4), std::invalid_argument);
+
+    // unweighted graph - the distance is the number of edges
+    g.loadGraph({{NO_EDGE, 1, NO_EDGE}, {NO_EDGE, NO_EDGE, 1}, {NO_EDGE, NO_EDGE, NO_EDGE}});
+    result = Algorithms::findShortestPath(g, 0, 2);
+    CHECK(result.distance == 2);
+    CHECK(result.path == vector<size_t>{0, 1, 2});
+
+    // negative weights
+    g.loadGraph({{NO_EDGE, 4, 1}, {NO_EDGE, NO_EDGE, NO_EDGE}, {NO_EDGE, -2, NO_EDGE}});
+    result = Algorithms::findShortestPath(g, 0, 1);
+    CHECK(result.status == Status::FOUND);
+    CHECK(result.distance == -1);
+    CHECK(result.path == vector<size_t>{0, 2, 1});
+
+    // negative cycle
+    g.loadGraph({{NO_EDGE, 1, NO_EDGE}, {NO_EDGE, NO_EDGE, -3}, {1, NO_EDGE, NO_EDGE}});
+    result = Algorithms::findShortestPath(g, 0, 2);
+    CHECK(result.status == Status::NEGATIVE_CYCLE);
+    CHECK(Algorithms::formatPath(result) == "Graph contains a negative-weight cycle");
+
+    // undirected graph with negative weights
+    g.loadGraph({{NO_EDGE, -10}, {-10, NO_EDGE}});
+    result = Algorithms::findShortestPath(g, 0, 1);
+    CHECK(result.status == Status::FOUND);
+    CHECK(result.distance == -10);
+    CHECK(result.path == vector<size_t>{0, 1});
+}
+
+TEST_CASE("Test shortestPathTree") {
+    Graph g;
+
+    // 0 -4-> 1 -1-> 2, 0 -7-> 2, 3 is not reachable
+    vector<vector<int>> graph = {
+        // clang-format off
+        {NO_EDGE, 4,       7,       NO_EDGE},
+        {NO_EDGE, NO_EDGE, 1,       NO_EDGE},
+        {NO_EDGE, NO_EDGE, NO_EDGE, NO_EDGE},
+        {NO_EDGE, NO_EDGE, 2,       NO_EDGE}
+        // clang-format on
+    };
+    g.loadGraph(graph);
+
+    Algorithms::ShortestPathTree tree = Algorithms::shortestPathTree(g, 0);
+    CHECK(tree.getSource() == 0);
+    CHECK(tree.hasNegativeCycle() == false);
+    CHECK(tree.distanceTo(0) == 0);
+    CHECK(tree.distanceTo(1) == 4);
+    CHECK(tree.distanceTo(2) == 5);
+    CHECK(tree.distanceTo(3) == INF);
+    CHECK(tree.isReachable(3) == false);
+    CHECK(tree.pathTo(2) == vector<size_t>{0, 1, 2});
+    CHECK(tree.pathTo(3).empty());
+    CHECK(tree.pathTo(0) == vector<size_t>{0});
+
+    // the tree gives the same answers as findShortestPath
+    for (size_t v = 0; v < 4; v++) {
+        Algorithms::ShortestPathResult expected = Algorithms::findShortestPath(g, 0, v);
+        Algorithms::ShortestPathResult result = tree.resultTo(v);
+        CHECK(result.status == expected.status);
+        CHECK(result.distance == expected.distance);
+        CHECK(result.path == expected.path);
+    }
+    CHECK_THROWS_AS(tree.distanceTo(4), std::out_of_range);
+    CHECK_THROWS_AS(tree.resultTo(4), std::out_of_range);
+    CHECK_THROWS_AS(Algorithms::shortestPathTree(g, 4), std::invalid_argument);
+
+    // the ids are the original ids after reorder
+    Graph h = g;
+    h.reorder(VertexOrder::DEGREE);
+    Algorithms::ShortestPathTree reorderedTree = Algorithms::shortestPathTree(h, 0);
+    CHECK(reorderedTree.distanceTo(2) == 5);
+    CHECK(reorderedTree.pathTo(2) == vector<size_t>{0, 1, 2});
+
+    // negative cycle
+    g.loadGraph({{NO_EDGE, 1, NO_EDGE}, {NO_EDGE, NO_EDGE, -3}, {1, NO_EDGE, NO_EDGE}});
+    tree = Algorithms::shortestPathTree(g, 0);
+    CHECK(tree.hasNegativeCycle() == true);
+    CHECK(tree.resultTo(2).status == Algorithms::ShortestPathResult::Status::NEGATIVE_CYCLE);
+    CHECK_THROWS_AS(tree.distanceTo(2), std::runtime_error);
+
+    // undirected with a negative edge: findShortestPath picks between the searches from both ends, so there is no tree
+    g.loadGraph({{NO_EDGE, 5, NO_EDGE, 6}, {5, NO_EDGE, 1, -3}, {NO_EDGE, 1, NO_EDGE, 3}, {6, -3, 3, NO_EDGE}});
+    CHECK_THROWS_AS(Algorithms::shortestPathTree(g, 0), std::invalid_argument);
+    CHECK_THROWS_AS(Algorithms::shortestPathTree(g, 0, QueuePolicy::AUTO, ExecutionPolicy::PARALLEL), std::invalid_argument);
+    g.loadGraph({{NO_EDGE, 5, NO_EDGE}, {5, NO_EDGE, 1}, {NO_EDGE, 1, NO_EDGE}});
+    CHECK(Algorithms::shortestPathTree(g, 0).distanceTo(2) == 6);
+}
+
+TEST_CASE("Test point-to-point Dijkstra matches the full search") {
+    // a 5x5 directed grid with positive weights (right and down edges, and a few shortcuts back)
+    size_t n = 25;
+    vector<vector<int>> graph(n, vector<int>(n, NO_EDGE));
+    for (size_t r = 0; r < 5; r++) {
+        for (size_t c = 0; c < 5; c++) {
+            size_t u = r * 5 + c;
+            if (c < 4) {
+                graph[u][u + 1] = (int)((u * 7) % 5 + 1);
+            }
+            if (r < 4) {
+                graph[u][u + 5] = (int)((u * 3) % 4 + 1);
+            }
+            if (u % 6 == 5) {
+                graph[u][u - 5] = 2;
+            }
+        }
+    }
+    Graph g;
+    g.loadGraph(graph);
+
+    for (size_t src = 0; src < n; src++) {
+        Algorithms::ShortestPathTree tree = Algorithms::shortestPathTree(g, src);
+        for (size_t dest = 0; dest < n; dest++) {
+            Algorithms::ShortestPathResult result = Algorithms::findShortestPath(g, src, dest);
+            CHECK(result.distance == tree.distanceTo(dest));
+            CHECK(result.path == tree.pathTo(dest));
+        }
+    }
+}
+
+TEST_CASE("Test priority queues") {
+    // all the queues pop the same {key, vertex} sequence, also after decrease-key
+    BinaryHeap binary(8);
+    IndexedDaryHeap<4> dary(8);
+    PairingHeap pairing(8);
+    DialBuckets dial(8, 12);  // the keys are pushed before the first pop, so the range is 1...12
+    RadixHeap radix(8);
+    vector<pair<size_t, int>> operations = {{3, 9}, {1, 4}, {5, 7}, {0, 12}, {3, 2}, {6, 4}, {5, 8}, {7, 1}, {0, 3}, {2, 5}};
+    for (auto [v, key] : operations) {
+        binary.push(v, key);
+        dary.push(v, key);
+        pairing.push(v, key);
+        dial.push(v, key);
+        radix.push(v, key);
+    }
+
+    vector<pair<int, size_t>> expected = {{1, 7}, {2, 3}, {3, 0}, {4, 1}, {4, 6}, {5, 2}, {7, 5}};
+    for (size_t i = 0; i < expected.size(); i++) {
+        CHECK(binary.pop() == expected[i]);
+        CHECK(dary.pop() == expected[i]);
+        CHECK(pairing.pop() == expected[i]);
+        CHECK(dial.pop() == expected[i]);
+        CHECK(radix.pop() == expected[i]);
+        if (i == 2) {  // a popped vertex can be pushed again
+            binary.push(0, 6);
+            dary.push(0, 6);
+            pairing.push(0, 6);
+            dial.push(0, 6);
+            radix.push(0, 6);
+            expected.insert(expected.begin() + 6, {6, 0});
+        }
+    }
+    CHECK(binary.empty());
+    CHECK(dary.empty());
+    CHECK(pairing.empty());
+    CHECK(dial.empty());
+    CHECK(radix.empty());
+
+    // Dijkstra gives the same paths with all the queues
+    Graph g;
+    vector<vector<int>> graph = {
+        // clang-format off
+        {NO_EDGE, 2,       6,       NO_EDGE, NO_EDGE},
+        {NO_EDGE, NO_EDGE, 3,       1,       NO_EDGE},
+        {NO_EDGE, NO_EDGE, NO_EDGE, NO_EDGE, 1      },
+        {NO_EDGE, NO_EDGE, 1,       NO_EDGE, 5      },
+        {1,       NO_EDGE, NO_EDGE, NO_EDGE, NO_EDGE}
+        // clang-format on
+    };
+    g.loadGraph(graph);
+    CHECK(g.getMaxEdgeWeight() == 6);
+    for (QueuePolicy policy : {QueuePolicy::AUTO, QueuePolicy::BINARY_HEAP, QueuePolicy::DARY_HEAP, QueuePolicy::PAIRING_HEAP, QueuePolicy::DIAL,
+                               QueuePolicy::RADIX_HEAP}) {
+        Algorithms::ShortestPathResult result = Algorithms::findShortestPath(g, 0, 4, policy);
+        CHECK(result.distance == 5);
+        CHECK(result.path == vector<size_t>{0, 1, 3, 2, 4});
+        CHECK(Algorithms::shortestPathTree(g, 1, policy).distanceTo(0) == 4);
+    }
+}
+
+TEST_CASE("Test bidirectionalShortestPath") {
+    using Status = Algorithms::ShortestPathResult::Status;
+    Graph g;
+
+    // unweighted directed graph: 0->1->2->3->4 and a shortcut 0->5->4
+    vector<vector<int>> graph = {
+        // clang-format off
+        {NO_EDGE, 1,       NO_EDGE, NO_EDGE, NO_EDGE, 1      },
+        {NO_EDGE, NO_EDGE, 1,       NO_EDGE, NO_EDGE, NO_EDGE},
+        {NO_EDGE, NO_EDGE, NO_EDGE, 1,       NO_EDGE, NO_EDGE},
+        {NO_EDGE, NO_EDGE, NO_EDGE, NO_EDGE, 1,       NO_EDGE},
+        {NO_EDGE, NO_EDGE, NO_EDGE, NO_EDGE, NO_EDGE, NO_EDGE},
+        {NO_EDGE, NO_EDGE, NO_EDGE, NO_EDGE, 1,       NO_EDGE}
+        // clang-format on
+    };
+    g.loadGraph(graph);
+    Algorithms::ShortestPathResult result = Algorithms::bidirectionalShortestPath(g, 0, 4);
+    CHECK(result.status == Status::FOUND);
+    CHECK(result.distance == 2);
+    CHECK(result.path == vector<size_t>{0, 5, 4});
+    CHECK(Algorithms::formatPath(Algorithms::bidirectionalShortestPath(g, 1, 4)) == "1->2->3->4");
+    CHECK(Algorithms::bidirectionalShortestPath(g, 4, 0).status == Status::NO_PATH);
+    CHECK(Algorithms::bidirectionalShortestPath(g, 3, 3).path == vector<size_t>{3});
+    CHECK_THROWS_AS(Algorithms::bidirectionalShortestPath(g, 0, 6), std::invalid_argument);
+
+    // weighted graph - the shortcut is longer
+    graph[0][5] = 5;
+    g.loadGraph(graph);
+    result = Algorithms::bidirectionalShortestPath(g, 0, 4);
+    CHECK(result.distance == 4);
+    CHECK(result.path == vector<size_t>{0, 1, 2, 3, 4});
+
+    // the same distances as findShortestPath on all the pairs of the grid of the point-to-point test
+    size_t n = 25;
+    vector<vector<int>> grid(n, vector<int>(n, NO_EDGE));
+    for (size_t u = 0; u < n; u++) {
+        if (u % 5 < 4) {
+            grid[u][u + 1] = (int)((u * 7) % 5 + 1);
+        }
+        if (u < 20) {
+            grid[u][u + 5] = (int)((u * 3) % 4 + 1);
+        }
+        if (u % 6 == 5) {
+            grid[u][u - 5] = 2;
+        }
+    }
+    g.loadGraph(grid);
+    for (size_t src = 0; src < n; src++) {
+        for (size_t dest = 0; dest < n; dest++) {
+            Algorithms::ShortestPathResult expected = Algorithms::findShortestPath(g, src, dest);
+            result = Algorithms::bidirectionalShortestPath(g, src, dest);
+            CHECK(result.status == expected.status);
+            CHECK(result.distance == expected.distance);
+        }
+    }
+
+    // negative weights fall back to Bellman-Ford
+    g.loadGraph({{NO_EDGE, 4, 1}, {NO_EDGE, NO_EDGE, NO_EDGE}, {NO_EDGE, -2, NO_EDGE}});
+    CHECK(Algorithms::bidirectionalShortestPath(g, 0, 1).path == vector<size_t>{0, 2, 1});
+}
+
+TEST_CASE("Test aStar") {
+    // a 4x4 undirected grid, the vertex r * 4 + c is at (c, r). the weight of an edge is 1 or 3
+    size_t n = 16;
+    vector<vector<int>> graph(n, vector<int>(n, NO_EDGE));
+    vector<pair<double, double>> coordinates(n);
+    for (size_t u = 0; u < n; u++) {
+        coordinates[u] = {(double)(u % 4), (double)(u / 4)};
+        if (u % 4 < 3) {
+            graph[u][u + 1] = graph[u + 1][u] = u % 3 == 0 ? 3 : 1;
+        }
+        if (u < 12) {
+            graph[u][u + 4] = graph[u + 4][u] = u % 5 == 0 ? 3 : 1;
+        }
+    }
+    Graph g;
+    g.loadGraph(graph);
+
+    // the landmark tables of the corners (the graph is undirected, so the distances to a landmark are the same as from it)
+    vector<vector<int>> landmarks;
+    for (size_t l : vector<size_t>{0, 3, 12, 15}) {
+        Algorithms::ShortestPathTree tree = Algorithms::shortestPathTree(g, l);
+        vector<int> distances(n);
+        for (size_t v = 0; v < n; v++) {
+            distances[v] = tree.distanceTo(v);
+        }
+        landmarks.push_back(distances);
+    }
+
+    EuclideanHeuristic euclidean(coordinates);
+    ManhattanHeuristic manhattan(coordinates);
+    AltHeuristic alt(landmarks, landmarks);
+    for (size_t src = 0; src < n; src++) {
+        for (size_t dest = 0; dest < n; dest++) {
+            Algorithms::ShortestPathResult expected = Algorithms::findShortestPath(g, src, dest);
+            CHECK(Algorithms::aStar(g, src, dest).distance == expected.distance);
+            CHECK(Algorithms::aStar(g, src, dest, euclidean).distance == expected.distance);
+            CHECK(Algorithms::aStar(g, src, dest, manhattan).distance == expected.distance);
+            CHECK(Algorithms::aStar(g, src, dest, alt).distance == expected.distance);
+            CHECK(alt(src, dest) <= expected.distance);
+        }
+    }
+    CHECK(manhattan(0, 15) == 6);
+    CHECK(euclidean(0, 5) == 1);
+
+    Algorithms::ShortestPathResult result = Algorithms::aStar(g, 0, 15, manhattan);
+    CHECK(result.status == Algorithms::ShortestPathResult::Status::FOUND);
+    CHECK(result.path.front() == 0);
+    CHECK(result.path.back() == 15);
+
+    // no path
+    g.loadGraph({{NO_EDGE, 2, NO_EDGE}, {NO_EDGE, NO_EDGE, NO_EDGE}, {NO_EDGE, 2, NO_EDGE}});
+    CHECK(Algorithms::aStar(g, 0, 2, EuclideanHeuristic({{0, 0}, {1, 0}, {2, 0}})).status == Algorithms::ShortestPathResult::Status::NO_PATH);
+    CHECK_THROWS_AS(Algorithms::aStar(g, 0, 3, manhattan), std::invalid_argument);
+}
+
+TEST_CASE("Test LandmarkIndex") {
+    Graph g;
+    g.loadGraph({{NO_EDGE, 4, NO_EDGE, NO_EDGE, 9, NO_EDGE},
+                 {NO_EDGE, NO_EDGE, 2, NO_EDGE, NO_EDGE, NO_EDGE},
+                 {1, NO_EDGE, NO_EDGE, 7, NO_EDGE, NO_EDGE},
+                 {NO_EDGE, NO_EDGE, NO_EDGE, NO_EDGE, NO_EDGE, 3},
+                 {NO_EDGE, NO_EDGE, 1, 2, NO_EDGE, NO_EDGE},
+                 {NO_EDGE, 5, NO_EDGE, NO_EDGE, NO_EDGE, NO_EDGE}});
+
+    for (LandmarkIndex::Selection selection : {LandmarkIndex::Selection::FARTHEST, LandmarkIndex::Selection::AVOID}) {
+        LandmarkIndex index(g, 3, selection);
+        CHECK(index.getLandmarks().size() == 3);
+        CHECK(index.isValidFor(g));
+        for (size_t src = 0; src < 6; src++) {
+            for (size_t dest = 0; dest < 6; dest++) {
+                Algorithms::ShortestPathResult expected = Algorithms::findShortestPath(g, src, dest);
+                Algorithms::ShortestPathResult result = index.query(g, src, dest);
+                CHECK(result.status == expected.status);
+                CHECK(result.distance == expected.distance);
+                CHECK(index.getHeuristic()(src, dest) <= expected.distance);
+            }
+        }
+    }
+    CHECK(LandmarkIndex(g, 100).getLandmarks().size() == 6);
+
+    // save and load
+    LandmarkIndex index(g, 2);
+    std::stringstream file;
+    index.save(file);
+    LandmarkIndex loaded = LandmarkIndex::load(file, g);
+    CHECK(loaded.getLandmarks() == index.getLandmarks());
+    CHECK(loaded.isValidFor(g));
+    CHECK(loaded.query(g, 0, 5).distance == 14);
+
+    Graph other;
+    other.loadGraph({{NO_EDGE, 1}, {1, NO_EDGE}});
+    file.clear();
+    file.seekg(0);
+    CHECK_THROWS_AS(LandmarkIndex::load(file, other), std::runtime_error);
+    std::stringstream garbage("not an index");
+    CHECK_THROWS_AS(LandmarkIndex::load(garbage, g), std::runtime_error);
+
+    // the index is out of date after the graph changes
+    g *= 1;
+    CHECK_FALSE(index.isValidFor(g));
+    CHECK_THROWS_AS(index.query(g, 0, 5), std::logic_error);
+
+    // negative weights
+    g.loadGraph({{NO_EDGE, -1}, {NO_EDGE, NO_EDGE}});
+    CHECK_THROWS_AS(LandmarkIndex(g, 1), std::invalid_argument);
+}
+
+TEST_CASE("Test ContractionHierarchy") {
+    // a 5x5 undirected grid
+    size_t n = 25;
+    vector<vector<int>> graph(n, vector<int>(n, NO_EDGE));
+    for (size_t u = 0; u < n; u++) {
+        if (u % 5 < 4) {
+            graph[u][u + 1] = graph[u + 1][u] = (int)(1 << (u % 5)) + (int)(u / 5) * 16;
+        }
+        if (u < 20) {
+            graph[u][u + 5] = graph[u + 5][u] = (int)(1 << (u / 5)) * 3 + (int)(u % 5) * 50;
+        }
+    }
+    Graph g;
+    g.loadGraph(graph);
+
+    ContractionHierarchy ch(g);
+    CHECK(ch.isValidFor(g));
+    CHECK(ch.getNumVertices() == n);
+    CHECK(ch.getBuildStats().numWitnessSearches > 0);
+    for (size_t src = 0; src < n; src++) {
+        for (size_t dest = 0; dest < n; dest++) {
+            // when there are several shortest paths the hierarchy may find another one, so check the length of the unpacked path
+            Algorithms::ShortestPathResult result = ch.query(src, dest);
+            CHECK(result.distance == Algorithms::findShortestPath(g, src, dest).distance);
+            CHECK(result.path.front() == src);
+            CHECK(result.path.back() == dest);
+            int length = 0;
+            for (size_t i = 0; i + 1 < result.path.size(); i++) {
+                CHECK(graph[result.path[i]][result.path[i + 1]] != NO_EDGE);
+                length += graph[result.path[i]][result.path[i + 1]];
+            }
+            CHECK(length == result.distance);
+        }
+    }
+
+    ContractionHierarchy::QueryStats stats;
+    Algorithms::ShortestPathResult result = ch.query(0, 24, &stats);
+    CHECK(result.distance == Algorithms::findShortestPath(g, 0, 24).distance);
+    CHECK(stats.settledVertices > 0);
+    CHECK(stats.settledVertices <= 2 * n);
+
+    // directed graph, with vertices that are not reachable
+    g.loadGraph({{NO_EDGE, 4, NO_EDGE, NO_EDGE, 9, NO_EDGE},
+                 {NO_EDGE, NO_EDGE, 2, NO_EDGE, NO_EDGE, NO_EDGE},
+                 {1, NO_EDGE, NO_EDGE, 7, NO_EDGE, NO_EDGE},
+                 {NO_EDGE, NO_EDGE, NO_EDGE, NO_EDGE, NO_EDGE, 3},
+                 {NO_EDGE, NO_EDGE, 1, 2, NO_EDGE, NO_EDGE},
+                 {NO_EDGE, 5, NO_EDGE, NO_EDGE, NO_EDGE, NO_EDGE}});
+    CHECK_FALSE(ch.isValidFor(g));
+    ContractionHierarchy directed(g);
+    for (size_t src = 0; src < 6; src++) {
+        for (size_t dest = 0; dest < 6; dest++) {
+            CHECK(directed.shortestPath(src, dest) == Algorithms::shortestPath(g, src, dest));
+        }
+    }
+    CHECK(directed.shortestPath(0, 5) == "0->4->3->5");
+    CHECK_THROWS_AS(directed.query(0, 6), std::invalid_argument);
+
+    // no path
+    g.loadGraph({{NO_EDGE, 2, NO_EDGE}, {NO_EDGE, NO_EDGE, NO_EDGE}, {NO_EDGE, 2, NO_EDGE}});
+    CHECK(ContractionHierarchy(g).query(0, 2).status == Algorithms::ShortestPathResult::Status::NO_PATH);
+    CHECK(ContractionHierarchy(g).shortestPath(1, 0) == "-1");
+
+    g.loadGraph({{NO_EDGE, -1}, {NO_EDGE, NO_EDGE}});
+    CHECK_THROWS_AS(ContractionHierarchy{g}, std::invalid_argument);
+}
+
 TEST_CASE("Test isContainsCycle for directed graph") {
     Graph g;
 
@@ -745,6 +1984,25 @@ TEST_CASE("Test negativeCycle for directed graph") {
 
     g.loadGraph(graph2);
     CHECK(Algorithms::negativeCycle(g) == "3->4->2->3");
+
+    // a long chain of negative edges is not a cycle, until the last vertex is connected back to the first
+    size_t n = 100;
+    vector<vector<int>> graph3(n, vector<int>(n, NO_EDGE));
+    for (size_t u = 0; u + 1 < n; u++) {
+        graph3[u][u + 1] = -1;
+    }
+    g.loadGraph(graph3);
+    CHECK(Algorithms::negativeCycle(g) == "No negative cycle");
+
+    graph3[n - 1][0] = (int)n - 1;  // the cycle has weight 0
+    g.loadGraph(graph3);
+    CHECK(Algorithms::negativeCycle(g) == "No negative cycle");
+
+    graph3[n - 1][0] = (int)n - 2;
+    g.loadGraph(graph3);
+    string cycle = Algorithms::negativeCycle(g);
+    CHECK(std::count(cycle.begin(), cycle.end(), '>') == n);
+    CHECK(cycle.substr(0, cycle.find('-')) == cycle.substr(cycle.rfind('>') + 1));
 }
 
 TEST_CASE("Test negativeCycle for undirected graph") {
@@ -765,3 +2023,138 @@ TEST_CASE("Test negativeCycle for undirected graph") {
     g.loadGraph(graph1);
     CHECK(Algorithms::negativeCycle(g) == "No negative cycle");
 }
+
+TEST_CASE("Test algorithms on memory-mapped CSR graph") {
+    string path = "csr_algorithms_test.bin";
+
+    // 0-->1-->2, 3-->1
+    {
+        CsrBuilder builder(path, 4, true, 2);
+        builder.addEdge(0, 1);
+        builder.addEdge(1, 2);
+        builder.addEdge(3, 1);
+        builder.finish();
+    }
+    {
+        MappedCsrGraph g(path);
+        CHECK(Algorithms::isConnected(g) == false);
+        CHECK(Algorithms::shortestPath(g, 0, 2) == "0->1->2");
+        CHECK(Algorithms::shortestPath(g, 3, 2) == "3->1->2");
+        CHECK(Algorithms::shortestPath(g, 2, 0) == "-1");
+        CHECK(Algorithms::shortestPath(g, 1, 1) == "1");
+        CHECK_THROWS_AS(Algorithms::shortestPath(g, 0, 4), std::invalid_argument);
+    }
+
+    // the root of the graph is not the first vertex
+    {
+        CsrBuilder builder(path, 4);
+        builder.addEdge(0, 1);
+        builder.addEdge(1, 2);
+        builder.addEdge(2, 0);
+        builder.addEdge(3, 1);
+        builder.finish();
+    }
+    {
+        MappedCsrGraph g(path);
+        CHECK(Algorithms::isConnected(g) == true);
+    }
+
+    // weighted graphs are not supported by shortestPath
+    {
+        CsrBuilder builder(path, 2, false);
+        builder.addEdge(0, 1, 4);
+        builder.finish();
+    }
+    {
+        MappedCsrGraph g(path);
+        CHECK(Algorithms::isConnected(g) == true);
+        CHECK_THROWS_AS(Algorithms::shortestPath(g, 0, 1), std::invalid_argument);
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Test algorithms on reordered graph") {
+    Graph g;
+    vector<vector<int>> graph = {
+        // clang-format off
+        {NO_EDGE, 1,       NO_EDGE, NO_EDGE, NO_EDGE},
+        {NO_EDGE, NO_EDGE, 1,       NO_EDGE, NO_EDGE},
+        {NO_EDGE, NO_EDGE, NO_EDGE, 1,       NO_EDGE},
+        {NO_EDGE, NO_EDGE, NO_EDGE, NO_EDGE, 1      },
+        {1,       NO_EDGE, NO_EDGE, NO_EDGE, NO_EDGE}
+        // clang-format on
+    };
+    g.loadGraph(graph);
+
+    for (VertexOrder order : {VertexOrder::RCM, VertexOrder::DEGREE, VertexOrder::BFS, VertexOrder::COMMUNITY}) {
+        Graph h = g;
+        h.reorder(order);
+        // the ids in the results are the original ids
+        CHECK(Algorithms::isConnected(h) == true);
+        CHECK(Algorithms::isStronglyConnected(h) == true);
+        CHECK(Algorithms::shortestPath(h, 1, 4) == "1->2->3->4");
+        CHECK(Algorithms::shortestPath(h, 4, 2) == "4->0->1->2");
+        CHECK(Algorithms::isBipartite(h) == "The graph is not bipartite");
+
+        // the cycle can start at any vertex of 0->1->2->3->4
+        string cycle = Algorithms::isContainsCycle(h);
+        CHECK(cycle.size() == string("0->1->2->3->4->0").size());
+        CHECK(cycle.front() == cycle.back());
+        CHECK(string("0->1->2->3->4->0->1->2->3->4").find(cycle.substr(0, cycle.size() - 3)) != string::npos);
+    }
+
+    // negative cycle and bipartite sets
+    vector<vector<int>> graph2 = {
+        // clang-format off
+        {NO_EDGE, 2,       NO_EDGE, NO_EDGE},
+        {NO_EDGE, NO_EDGE, -3,      NO_EDGE},
+        {NO_EDGE, NO_EDGE, NO_EDGE, 4      },
+        {NO_EDGE, -5,      NO_EDGE, NO_EDGE}
+        // clang-format on
+    };
+    g.loadGraph(graph2);
+    Graph h = g;
+    h.reorder(VertexOrder::DEGREE);
+    string cycle = Algorithms::negativeCycle(h);
+    CHECK((cycle == "1->2->3->1" || cycle == "2->3->1->2" || cycle == "3->1->2->3"));
+    CHECK(Algorithms::shortestPath(h, 0, 3) == "Graph contains a negative-weight cycle");
+    CHECK(Algorithms::isBipartite(h) == "The graph is not bipartite");
+
+    vector<vector<int>> graph3 = {
+        // clang-format off
+        {NO_EDGE, 1,       NO_EDGE, NO_EDGE},
+        {1,       NO_EDGE, 1,       NO_EDGE},
+        {NO_EDGE, 1,       NO_EDGE, 1      },
+        {NO_EDGE, NO_EDGE, 1,       NO_EDGE}
+        // clang-format on
+    };
+    g.loadGraph(graph3);
+    h = g;
+    h.reorder(VertexOrder::RCM);
+    CHECK(Algorithms::isBipartite(h) == "The graph is bipartite: A={0,2}, B={1,3}");
+
+    // undirected with a negative edge: Bellman-Ford depends on the order of the relaxations, so it runs in the original order
+    vector<vector<int>> graph4 = {
+        // clang-format off
+        {NO_EDGE, 5,       NO_EDGE, 6      },
+        {5,       NO_EDGE, 1,       -3     },
+        {NO_EDGE, 1,       NO_EDGE, 3      },
+        {6,       -3,      3,       NO_EDGE}
+        // clang-format on
+    };
+    g.loadGraph(graph4);
+    for (VertexOrder order : {VertexOrder::RCM, VertexOrder::DEGREE, VertexOrder::BFS, VertexOrder::COMMUNITY}) {
+        h = g;
+        h.reorder(order);
+        for (size_t src = 0; src < 4; src++) {
+            for (size_t dest = 0; dest < 4; dest++) {
+                Algorithms::ShortestPathResult expected = Algorithms::findShortestPath(g, src, dest);
+                Algorithms::ShortestPathResult actual = Algorithms::findShortestPath(h, src, dest);
+                CHECK(actual.status == expected.status);
+                CHECK(actual.distance == expected.distance);
+                CHECK(actual.path == expected.path);
+            }
+        }
+    }
+}